@@ -0,0 +1,31 @@
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int arena_init(_arena* arena, size_t capacity)
+{
+    (*arena).capacity = arena_footprint(capacity ? capacity : 1);
+    (*arena).used = 0;
+    (*arena).base = aligned_alloc(ARENA_ALIGNMENT, (*arena).capacity);
+    return (*arena).base ? 0 : -1;
+}
+
+void* arena_alloc(_arena* arena, size_t size)
+{
+    size_t footprint = arena_footprint(size);
+    if (footprint > (*arena).capacity - (*arena).used){
+        return NULL;
+    }
+    void* block = (*arena).base + (*arena).used;
+    (*arena).used += footprint;
+    memset(block, 0, size);
+    return block;
+}
+
+void arena_free(_arena* arena)
+{
+    free((*arena).base);
+    (*arena).base = NULL;
+    (*arena).capacity = (*arena).used = 0;
+}
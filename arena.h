@@ -0,0 +1,38 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_ALIGNMENT 64              // Every allocation starts on its own cache line
+
+/* One block of memory handed out front to back and released all at once */
+typedef struct Arena {
+    unsigned char* base;                // The block (NULL until arena_init)
+    size_t capacity;                    // The size of the block in bytes
+    size_t used;                        // The bytes already handed out, padding included
+} _arena;
+
+/**
+ * Returns the bytes arena_alloc needs for an allocation of size bytes, padding included
+ */
+static inline size_t arena_footprint(size_t size)
+{
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+}
+
+/**
+ * Allocates a block of capacity bytes. Returns 0 on success, -1 if the allocation fails.
+ */
+int arena_init(_arena* arena, size_t capacity);
+
+/**
+ * Returns size zeroed bytes from arena, or NULL once the arena is exhausted
+ */
+void* arena_alloc(_arena* arena, size_t size);
+
+/**
+ * Releases the block and everything allocated from it
+ */
+void arena_free(_arena* arena);
+
+#endif
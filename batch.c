@@ -0,0 +1,506 @@
+#include "batch.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "scheduler.h"
+#include "thread_pool.h"
+
+/* One input of the batch, parsed once and shared by all of its jobs */
+typedef struct BatchWorkload {
+    const char* path;                   // The input file
+    _process_spec* processes;           // The parsed processes (NULL until loaded)
+    uint32_t processCount;              // The number of parsed processes
+    _arrival_index arrivals;            // The arrival order shared by the jobs
+    atomic_uint remainingJobs;          // Jobs still using processes; the last one frees them
+    char loadError[128];                // Why the input is malformed, when it is
+    struct BatchJob* jobs;              // This input's jobs, one per (algorithm, quantum)
+} _batch_workload;
+
+/* One (input, algorithm, quantum) run and its summary */
+typedef struct BatchJob {
+    struct BatchRun* run;               // The batch the job belongs to
+    _batch_workload* workload;          // The input the job simulates
+    const _scheduling_algorithm* algorithm; // The algorithm to simulate
+    uint32_t quantum;                   // The RR quantum (ignored by the other algorithms)
+    int status;                         // 0 once finished, -1 unreadable input, -2 out of memory, -3 malformed input,
+                                        // -4 unwritable report, -5 unwritable trace
+    _summary_data summary;              // The run's summary metrics
+} _batch_job;
+
+/* Everything shared by the jobs of one batch */
+typedef struct BatchRun {
+    const _batch_config* config;        // The sweep being run
+    _random_source randomSource;        // The random table, loaded once for every job
+    _thread_pool* pool;                 // The pool the jobs run on
+    uint32_t jobsPerWorkload;           // (algorithm, quantum) pairs per input
+} _batch_run;
+
+void batch_config_init(_batch_config* config)
+{
+    memset(config, 0, sizeof(*config));
+    (*config).outputDirectory = BATCH_DEFAULT_OUTPUT_DIR;
+    (*config).quanta[0] = QUANTUM;
+    (*config).quantumCount = 1;
+    for (uint32_t i = 0; i < DEFAULT_ALGORITHM_COUNT; i++){
+        (*config).algorithms[i] = &ALGORITHMS[i];
+    }
+    (*config).algorithmCount = DEFAULT_ALGORITHM_COUNT;
+    (*config).threadCount = thread_pool_default_size();
+    (*config).reportFlags = REPORT_DEFAULT;
+}
+
+int parse_quanta(const char* list, _batch_config* config)
+{
+    uint32_t count = 0;
+    const char* current = list;
+
+    while (*current){
+        char* end;
+        errno = 0;
+        unsigned long quantum = strtoul(current, &end, 10);
+        if (end == current || errno || quantum == 0 || quantum > INT32_MAX || count == BATCH_MAX_QUANTA
+                || (*end != ',' && *end != '\0')){
+            return -1;
+        }
+        (*config).quanta[count++] = (uint32_t) quantum;
+        current = *end == ',' ? end + 1 : end;
+    }
+    if (!count){
+        return -1;
+    }
+    (*config).quantumCount = count;
+    return 0;
+}
+
+int parse_algorithms(const char* list, _batch_config* config)
+{
+    uint32_t count = 0;
+    const char* current = list;
+
+    while (*current){
+        size_t length = strcspn(current, ",");
+        uint32_t i = 0;
+        while (i < ALGORITHM_COUNT && (strlen(ALGORITHMS[i].key) != length
+                                       || strncmp(ALGORITHMS[i].key, current, length) != 0)){
+            i++;
+        }
+        if (i == ALGORITHM_COUNT || count == ALGORITHM_COUNT){
+            return -1;
+        }
+        (*config).algorithms[count++] = &ALGORITHMS[i];
+        current += current[length] == ',' ? length + 1 : length;
+    }
+    if (!count){
+        return -1;
+    }
+    (*config).algorithmCount = count;
+    return 0;
+}
+
+static int compare_names(const void* left, const void* right)
+{
+    return strcmp(*(char* const*) left, *(char* const*) right);
+}
+
+/**
+ * Appends a copy of path to the growing list of input paths
+ */
+static int add_input(char*** paths, uint32_t* count, uint32_t* capacity, const char* path)
+{
+    if (*count == *capacity){
+        uint32_t grown = *capacity ? *capacity * 2 : 64;
+        char** larger = realloc(*paths, grown * sizeof(char*));
+        if (!larger){
+            return -1;
+        }
+        *paths = larger;
+        *capacity = grown;
+    }
+    (*paths)[*count] = strdup(path);
+    return (*paths)[(*count)++] ? 0 : -1;
+}
+
+/**
+ * The file name of path, the part its reports are named after
+ */
+static const char* input_name(const char* path)
+{
+    const char* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+static int compare_input_names(const void* left, const void* right)
+{
+    return strcmp(input_name(*(char* const*) left), input_name(*(char* const*) right));
+}
+
+/**
+ * Finds two of the count paths with the same file name, whose jobs would write the same report files.
+ * Returns 0 if the names are all distinct, -1 with first and second set if not, -2 if there's no memory to check.
+ */
+static int find_duplicate_name(char* const paths[], uint32_t count, const char** first, const char** second)
+{
+    char** sorted = malloc((count ? count : 1) * sizeof(char*));
+    int status = 0;
+    if (!sorted){
+        return -2;
+    }
+    memcpy(sorted, paths, count * sizeof(char*));
+    qsort(sorted, count, sizeof(char*), compare_input_names);
+    for (uint32_t i = 1; i < count && status == 0; i++){
+        if (strcmp(input_name(sorted[i - 1]), input_name(sorted[i])) == 0){
+            *first = sorted[i - 1];
+            *second = sorted[i];
+            status = -1;
+        }
+    }
+    free(sorted);
+    return status;
+}
+
+/**
+ * Frees the count paths collect_inputs listed, and the list
+ */
+static void free_inputs(char** paths, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++){
+        free(paths[i]);
+    }
+    free(paths);
+}
+
+/**
+ * Lists the inputs of the batch: the regular, non-hidden files of a directory in name order,
+ * or the non-blank, non-comment lines of a manifest (relative paths are relative to the manifest).
+ */
+static int collect_inputs(const char* input_path, char*** paths, uint32_t* count)
+{
+    uint32_t capacity = 0;
+    char path[BATCH_PATH_LENGTH];
+    struct stat info;
+
+    *paths = NULL;
+    *count = 0;
+    if (stat(input_path, &info) != 0){
+        return -1;
+    }
+
+    if (S_ISDIR(info.st_mode)){
+        DIR* directory = opendir(input_path);
+        struct dirent* entry;
+        if (!directory){
+            return -1;
+        }
+        while ((entry = readdir(directory))){
+            if ((*entry).d_name[0] == '.'){
+                continue;
+            }
+            snprintf(path, sizeof(path), "%s/%s", input_path, (*entry).d_name);
+            if (stat(path, &info) != 0 || !S_ISREG(info.st_mode)){
+                continue;
+            }
+            if (add_input(paths, count, &capacity, path) != 0){
+                closedir(directory);
+                return -1;
+            }
+        }
+        closedir(directory);
+        qsort(*paths, *count, sizeof(char*), compare_names);
+        return 0;
+    }
+
+    FILE* manifest = fopen(input_path, "r");
+    if (!manifest){
+        return -1;
+    }
+    const char* slash = strrchr(input_path, '/');
+    int directory_length = slash ? (int) (slash - input_path) : 0;
+    char line[BATCH_PATH_LENGTH];
+    while (fgets(line, sizeof(line), manifest)){
+        char* start = line;
+        char* end = line + strlen(line);
+        while (*start == ' ' || *start == '\t'){
+            start++;
+        }
+        while (end > start && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')){
+            *--end = '\0';
+        }
+        if (*start == '\0' || *start == '#'){
+            continue;
+        }
+        if (*start == '/' || !slash){
+            snprintf(path, sizeof(path), "%s", start);
+        }
+        else{
+            snprintf(path, sizeof(path), "%.*s/%s", directory_length, input_path, start);
+        }
+        if (add_input(paths, count, &capacity, path) != 0){
+            fclose(manifest);
+            return -1;
+        }
+    }
+    fclose(manifest);
+    return 0;
+}
+
+static void release_workload(_batch_workload* workload)
+{
+    if (atomic_fetch_sub(&(*workload).remainingJobs, 1) == 1){
+        free((*workload).processes);
+        free((void*) (*workload).arrivals.order);
+        (*workload).processes = NULL;
+        (*workload).arrivals.order = NULL;
+    }
+}
+
+/**
+ * Simulates one job and writes its report to <output>/<input name>.<algorithm>[.q<quantum>].txt
+ */
+static void run_job(void* argument)
+{
+    _batch_job* job = argument;
+    _batch_workload* workload = (*job).workload;
+    const _batch_config* config = (*(*job).run).config;
+    char report_name[BATCH_PATH_LENGTH];
+    _report_writer writer;
+    _simulation sim;
+
+    char trace_name[BATCH_PATH_LENGTH];
+    if (report_file_name(report_name, sizeof(report_name), (*config).outputDirectory, (*workload).path,
+                         (*job).algorithm, (*job).quantum, ".txt") != 0
+            || ((*config).traceDirectory && report_file_name(trace_name, sizeof(trace_name), (*config).traceDirectory,
+                                                             (*workload).path, (*job).algorithm, (*job).quantum,
+                                                             TRACE_FILE_SUFFIX) != 0)){
+        (*job).status = -4;
+        release_workload(workload);
+        return;
+    }
+    if (simulation_init(&sim, (*workload).processes, (*workload).processCount, &(*workload).arrivals,
+                        &(*(*job).run).randomSource, (*job).quantum, (*(*(*job).run).config).cpuCount) != 0){
+        (*job).status = -2;
+        release_workload(workload);
+        return;
+    }
+    sim.reportFlags = (*config).reportFlags;
+    FILE* out = fopen(report_name, "w");
+    if (!out){
+        (*job).status = -4;
+    }
+    else{
+        int ran = 0, traced = 0;
+        if (report_writer_init(&writer, out) == 0){
+            if ((*config).traceDirectory){
+                traced = run_and_report_traced((*job).algorithm, &sim, &writer, trace_name);
+                ran = traced == -2 ? -1 : 0;
+            }
+            else{
+                ran = run_and_report((*job).algorithm, &sim, &writer);
+            }
+            report_char(&writer, '\n');
+        }
+        int closed = report_writer_close(&writer);
+        if (fclose(out) != 0 || closed != 0){
+            (*job).status = -4;
+        }
+        else if (ran != 0){
+            (*job).status = -2;
+            remove(report_name);
+        }
+        else if (traced != 0){
+            (*job).status = -5;
+        }
+        compute_summary(&sim, &(*job).summary);
+    }
+    simulation_free(&sim);
+    release_workload(workload);
+}
+
+/**
+ * Parses one input, then fans its jobs out onto the pool (idle workers steal them)
+ */
+static void load_workload(void* argument)
+{
+    _batch_workload* workload = argument;
+    _batch_run* run = (*(*workload).jobs).run;
+    int status = load_processes((*workload).path, &(*workload).processes, &(*workload).processCount,
+                                (*workload).loadError, sizeof((*workload).loadError));
+
+    if (status == 0 && build_arrival_index((*workload).processes, (*workload).processCount, &(*workload).arrivals) != 0){
+        free((*workload).processes);
+        (*workload).processes = NULL;
+        status = -2;
+    }
+    if (status != 0){
+        for (uint32_t i = 0; i < (*run).jobsPerWorkload; i++){
+            (*workload).jobs[i].status = status;
+        }
+        return;
+    }
+
+    atomic_store(&(*workload).remainingJobs, (*run).jobsPerWorkload);
+    for (uint32_t i = 0; i < (*run).jobsPerWorkload; i++){
+        if (thread_pool_submit((*run).pool, run_job, &(*workload).jobs[i]) != 0){
+            run_job(&(*workload).jobs[i]);
+        }
+    }
+}
+
+/**
+ * Writes a CSV field, quoting it when it contains a comma, quote or newline
+ */
+static void write_csv_field(FILE* out, const char* field)
+{
+    if (!strpbrk(field, ",\"\n")){
+        fputs(field, out);
+        return;
+    }
+    fputc('"', out);
+    for (; *field; field++){
+        if (*field == '"'){
+            fputc('"', out);
+        }
+        fputc(*field, out);
+    }
+    fputc('"', out);
+}
+
+static int write_summary(const _batch_run* run, const _batch_workload* workloads, uint32_t workload_count)
+{
+    char summary_name[BATCH_PATH_LENGTH];
+    snprintf(summary_name, sizeof(summary_name), "%s/%s", (*(*run).config).outputDirectory, BATCH_SUMMARY_FILE_NAME);
+    FILE* out = fopen(summary_name, "w");
+    if (!out){
+        fprintf(stderr, "can't write %s\n", summary_name);
+        return -1;
+    }
+
+    fprintf(out, "input,algorithm,quantum,processes,finishing_time,cpu_utilisation,io_utilisation,"
+                 "throughput,average_turnaround_time,average_waiting_time\n");
+    for (uint32_t i = 0; i < workload_count; i++){
+        for (uint32_t j = 0; j < (*run).jobsPerWorkload; j++){
+            const _batch_job* job = &workloads[i].jobs[j];
+            if ((*job).status != 0){
+                continue;
+            }
+            write_csv_field(out, workloads[i].path);
+            fprintf(out, ",%s,", (*(*job).algorithm).key);
+            if ((*(*job).algorithm).usesQuantum){
+                fprintf(out, "%u", (*job).quantum);
+            }
+            fprintf(out, ",%u,%u,%6f,%6f,%6f,%6f,%6f\n", workloads[i].processCount, (*job).summary.finishingTime,
+                    (*job).summary.cpuUtilisation, (*job).summary.ioUtilisation, (*job).summary.throughput,
+                    (*job).summary.averageTurnaroundTime, (*job).summary.averageWaitingTime);
+        }
+    }
+    return fclose(out) == 0 ? 0 : -1;
+}
+
+int run_batch(const _batch_config* config)
+{
+    static const char* failures[] = { "", "can't read input", "out of memory", "malformed input", "can't write report",
+                                    "can't write trace" };
+    _batch_run run;
+    char** paths;
+    uint32_t path_count, i, j, k;
+    int result = 0;
+
+    memset(&run, 0, sizeof(run));
+    run.config = config;
+    for (i = 0; i < (*config).algorithmCount; i++){
+        run.jobsPerWorkload += (*(*config).algorithms[i]).usesQuantum ? (*config).quantumCount : 1;
+    }
+
+    if (collect_inputs((*config).inputPath, &paths, &path_count) != 0){
+        fprintf(stderr, "can't list inputs in %s\n", (*config).inputPath);
+        free_inputs(paths, path_count);
+        return -1;
+    }
+    const char* first;
+    const char* second;
+    int duplicate = find_duplicate_name(paths, path_count, &first, &second);
+    if (duplicate != 0){
+        if (duplicate == -1){
+            fprintf(stderr, "%s and %s would write the same reports; give inputs distinct file names\n", first, second);
+        }
+        else{
+            fprintf(stderr, "out of memory starting a batch of %u inputs\n", path_count);
+        }
+        free_inputs(paths, path_count);
+        return -1;
+    }
+    if (mkdir((*config).outputDirectory, 0777) != 0 && errno != EEXIST){
+        fprintf(stderr, "can't create %s\n", (*config).outputDirectory);
+        free_inputs(paths, path_count);
+        return -1;
+    }
+    if ((*config).traceDirectory && mkdir((*config).traceDirectory, 0777) != 0 && errno != EEXIST){
+        fprintf(stderr, "can't create %s\n", (*config).traceDirectory);
+        free_inputs(paths, path_count);
+        return -1;
+    }
+    if (random_source_load(&run.randomSource, RANDOM_NUMBER_FILE_NAME) != 0){
+        printf("%s not found\n", RANDOM_NUMBER_FILE_NAME);
+        free_inputs(paths, path_count);
+        return -1;
+    }
+
+    _batch_workload* workloads = calloc(path_count ? path_count : 1, sizeof(_batch_workload));
+    _batch_job* jobs = calloc(path_count ? (size_t) path_count * run.jobsPerWorkload : 1, sizeof(_batch_job));
+    run.pool = thread_pool_create((*config).threadCount);
+    if (!workloads || !jobs || !run.pool){
+        fprintf(stderr, "out of memory starting a batch of %u inputs\n", path_count);
+        thread_pool_destroy(run.pool);
+        random_source_free(&run.randomSource);
+        free_inputs(paths, path_count);
+        free(workloads);
+        free(jobs);
+        return -1;
+    }
+
+    for (i = 0; i < path_count; i++){
+        _batch_job* job = &jobs[(size_t) i * run.jobsPerWorkload];
+        workloads[i].path = paths[i];
+        workloads[i].jobs = job;
+        for (j = 0; j < (*config).algorithmCount; j++){
+            const _scheduling_algorithm* algorithm = (*config).algorithms[j];
+            for (k = 0; k < ((*algorithm).usesQuantum ? (*config).quantumCount : 1); k++){
+                (*job).run = &run;
+                (*job).workload = &workloads[i];
+                (*job).algorithm = algorithm;
+                (*job).quantum = (*algorithm).usesQuantum ? (*config).quanta[k] : QUANTUM;
+                job++;
+            }
+        }
+        if (thread_pool_submit(run.pool, load_workload, &workloads[i]) != 0){
+            load_workload(&workloads[i]);
+        }
+    }
+    thread_pool_wait(run.pool);
+    thread_pool_destroy(run.pool);
+
+    for (i = 0; i < path_count; i++){
+        for (j = 0; j < run.jobsPerWorkload; j++){
+            int status = workloads[i].jobs[j].status;
+            if (status != 0){
+                fprintf(stderr, "%s (%s): %s\n", workloads[i].path, (*workloads[i].jobs[j].algorithm).key,
+                        status == -3 ? workloads[i].loadError : failures[-status]);
+                result = -1;
+            }
+        }
+    }
+    if (write_summary(&run, workloads, path_count) != 0){
+        result = -1;
+    }
+
+    free_inputs(paths, path_count);
+    free(workloads);
+    free(jobs);
+    random_source_free(&run.randomSource);
+    return result;
+}
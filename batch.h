@@ -0,0 +1,52 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdint.h>
+
+#include "scheduler.h"
+
+#define BATCH_DEFAULT_OUTPUT_DIR "batch-output"
+#define BATCH_MAX_QUANTA 64
+#define BATCH_PATH_LENGTH 4096         // Longest input or report path
+#define BATCH_SUMMARY_FILE_NAME "summary.csv"
+
+/* What a batch run sweeps over and where its output goes */
+typedef struct BatchConfig {
+    const char* inputPath;              // A directory of inputs, or a manifest naming one input per line
+    const char* outputDirectory;        // Where the per-job reports and summary.csv are written
+    const char* traceDirectory;         // Where the per-job traces are written (NULL when tracing is off)
+    uint32_t quanta[BATCH_MAX_QUANTA];  // The RR quanta to sweep; other algorithms run once per input
+    uint32_t quantumCount;              // The number of quanta
+    const _scheduling_algorithm* algorithms[ALGORITHM_COUNT]; // The algorithms to run, in report order
+    uint32_t algorithmCount;            // The number of algorithms
+    uint32_t threadCount;               // The number of worker threads
+    uint32_t cpuCount;                  // The simulated CPUs of every run (0 runs the uniprocessor engines)
+    uint32_t reportFlags;               // What every report includes (REPORT_* flags)
+} _batch_config;
+
+/**
+ * Fills config with the defaults: no input, BATCH_DEFAULT_OUTPUT_DIR, FCFS, RR and SJF, QUANTUM only,
+ * one thread per CPU, REPORT_DEFAULT reports
+ */
+void batch_config_init(_batch_config* config);
+
+/**
+ * Parses a comma separated list of positive quanta into config. Returns 0 on success, -1 if the list is invalid.
+ */
+int parse_quanta(const char* list, _batch_config* config);
+
+/**
+ * Parses a comma separated list of algorithm keys (fcfs, rr, sjf, srtf, mlfq, priority) into config.
+ * Returns 0 on success, -1 if the list is invalid.
+ */
+int parse_algorithms(const char* list, _batch_config* config);
+
+/**
+ * Runs every (input x algorithm x quantum) job in config on a work-stealing pool, writing one report per
+ * job and a combined summary.csv. The random table is loaded once and each input is parsed once.
+ * Reports are named after the input's file name, so a batch whose inputs share one is refused.
+ * Returns 0 when every job succeeded, -1 otherwise.
+ */
+int run_batch(const _batch_config* config);
+
+#endif
@@ -0,0 +1,178 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "scheduler.h"
+#include "policy.h"
+
+/* The fastest time of one phase and the work it did */
+typedef struct BenchPhase {
+    const char* phase;                  // load, simulate, simulate-dynamic or report
+    const _scheduling_algorithm* algorithm; // The algorithm simulated (NULL for load)
+    double seconds;                     // The fastest of the repeated runs
+    uint64_t cycles;                    // Simulated cycles (the final cycle of the run)
+    uint64_t events;                    // Cycles the engine actually stepped through (0 unless simulated)
+} _bench_phase;
+
+static double per_second(uint64_t count, double seconds)
+{
+    return seconds > 0 ? count / seconds : 0;
+}
+
+/**
+ * Prints phase and appends it to results. Cycle and event rates only mean something for
+ * the simulate phase; every phase gets a processes per second rate.
+ */
+static void record(FILE* results, const char* input_path, uint32_t process_count, const _bench_phase* phase)
+{
+    const char* key = (*phase).algorithm ? (*(*phase).algorithm).key : "";
+    int simulated = (*phase).events != 0;
+
+    printf("%-16s %-8s %12.6f s %14.0f processes/s", (*phase).phase, key, (*phase).seconds,
+           per_second(process_count, (*phase).seconds));
+    if (simulated){
+        printf(" %14.0f cycles/s %14.0f events/s", per_second((*phase).cycles, (*phase).seconds),
+               per_second((*phase).events, (*phase).seconds));
+    }
+    printf("\n");
+
+    fprintf(results, "%s,%u,%s,%s,", input_path, process_count, (*phase).phase, key);
+    if ((*phase).algorithm && (*(*phase).algorithm).usesQuantum){
+        fprintf(results, "%u", QUANTUM);
+    }
+    fprintf(results, ",%.9f,", (*phase).seconds);
+    if (simulated){
+        fprintf(results, "%llu,%llu,%.0f,%.0f", (unsigned long long) (*phase).cycles,
+                (unsigned long long) (*phase).events, per_second((*phase).cycles, (*phase).seconds),
+                per_second((*phase).events, (*phase).seconds));
+    }
+    else{
+        fprintf(results, ",,,");
+    }
+    fprintf(results, ",%.0f\n", per_second(process_count, (*phase).seconds));
+}
+
+int run_bench(const char* input_path, const char* results_path, uint32_t repeats,
+              const _scheduling_algorithm* const algorithms[], uint32_t algorithm_count)
+{
+    _random_source randomSource;
+    _process_spec* process_list = NULL;
+    _arrival_index arrivals;
+    uint32_t count = 0;
+    _bench_phase load = { "load", NULL, 0, 0, 0 };
+
+    repeats = repeats ? repeats : 1;
+    if (random_source_load(&randomSource, RANDOM_NUMBER_FILE_NAME) != 0){
+        printf("%s not found\n", RANDOM_NUMBER_FILE_NAME);
+        return -1;
+    }
+    FILE* results = fopen(results_path, "a");
+    if (!results){
+        fprintf(stderr, "can't write %s\n", results_path);
+        random_source_free(&randomSource);
+        return -1;
+    }
+    if (fseek(results, 0, SEEK_END) == 0 && ftell(results) == 0){
+        fputs(BENCH_RESULTS_HEADER, results);
+    }
+
+    // The input phase: parsing plus the arrival index every run shares
+    for (uint32_t i = 0; i < repeats; i++){
+        if (i){
+            free(process_list);
+            free((void*) arrivals.order);
+        }
+        double start = profile_now();
+        if (load_processes(input_path, &process_list, &count, NULL, 0) != 0){
+            printf("can't load %s\n", input_path);
+            fclose(results);
+            random_source_free(&randomSource);
+            return -1;
+        }
+        if (build_arrival_index(process_list, count, &arrivals) != 0){
+            printf("Out of memory indexing %i processes\n", count);
+            free(process_list);
+            fclose(results);
+            random_source_free(&randomSource);
+            return -1;
+        }
+        double elapsed = profile_now() - start;
+        load.seconds = i == 0 || elapsed < load.seconds ? elapsed : load.seconds;
+    }
+    printf("%s: %u processes, best of %u\n", input_path, count, repeats);
+    record(results, input_path, count, &load);
+
+    int status = 0;
+    for (uint32_t a = 0; a < algorithm_count && status == 0; a++){
+        const _scheduling_algorithm* algorithm = algorithms[a];
+        _bench_phase specialised = { "simulate", algorithm, 0, 0, 0 };
+        _bench_phase dynamic = { "simulate-dynamic", algorithm, 0, 0, 0 };
+        _bench_phase report = { "report", algorithm, 0, 0, 0 };
+
+        for (uint32_t i = 0; i < repeats && status == 0; i++){
+            _simulation sim;
+            _report_writer out;
+
+            // The same run through the engine with the policy's hooks called through pointers
+            if (simulation_init(&sim, process_list, count, &arrivals, &randomSource, QUANTUM, 0) != 0){
+                printf("Out of memory simulating %i processes\n", count);
+                status = -1;
+                break;
+            }
+            double start = profile_now();
+            int ran = simulate(&sim, (*algorithm).policy);
+            double simulated = profile_now() - start;
+            dynamic.cycles = sim.currentCycle - 1;
+            dynamic.events = sim.eventCount;
+            dynamic.seconds = i == 0 || simulated < dynamic.seconds ? simulated : dynamic.seconds;
+            simulation_free(&sim);
+
+            if (simulation_init(&sim, process_list, count, &arrivals, &randomSource, QUANTUM, 0) != 0){
+                printf("Out of memory simulating %i processes\n", count);
+                status = -1;
+                break;
+            }
+            start = profile_now();
+            ran |= (*algorithm).run(&sim);
+            simulated = profile_now() - start;
+            if (ran != 0){
+                printf("Out of memory simulating %i processes\n", count);
+                simulation_free(&sim);
+                status = -1;
+                break;
+            }
+
+            // The output phase formats the whole report in memory, so the disk isn't timed
+            start = profile_now();
+            if (report_writer_init(&out, NULL) == 0){
+                write_report(algorithm, &sim, &out);
+            }
+            double reported = profile_now() - start;
+            if (report_writer_close(&out) != 0){
+                printf("Out of memory reporting %s\n", (*algorithm).name);
+                status = -1;
+            }
+
+            specialised.cycles = sim.currentCycle - 1;
+            specialised.events = sim.eventCount;
+            specialised.seconds = i == 0 || simulated < specialised.seconds ? simulated : specialised.seconds;
+            report.seconds = i == 0 || reported < report.seconds ? reported : report.seconds;
+            simulation_free(&sim);
+        }
+        if (status == 0){
+            record(results, input_path, count, &specialised);
+            record(results, input_path, count, &dynamic);
+            record(results, input_path, count, &report);
+        }
+    }
+
+    if (fclose(results) != 0){
+        fprintf(stderr, "can't write %s\n", results_path);
+        status = -1;
+    }
+    free((void*) arrivals.order);
+    free(process_list);
+    random_source_free(&randomSource);
+    return status;
+}
@@ -0,0 +1,22 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+#include "scheduler.h"
+
+#define BENCH_DEFAULT_REPEATS 3
+#define BENCH_RESULTS_HEADER "workload,processes,phase,algorithm,quantum,seconds,cycles,events," \
+                             "cycles_per_second,events_per_second,processes_per_second\n"
+
+/**
+ * Times loading input_path, then simulating and reporting it under each of the algorithm_count algorithms,
+ * keeping the fastest of repeats runs of every phase. Each algorithm is simulated twice: by its own
+ * specialised engine (simulate) and by the engine calling its policy through pointers (simulate-dynamic).
+ * A table goes to stdout and one CSV row per phase is appended to results_path (with BENCH_RESULTS_HEADER
+ * when the file is new). Returns 0 on success, -1 if the input, the random numbers or the results file can't be used.
+ */
+int run_bench(const char* input_path, const char* results_path, uint32_t repeats,
+              const _scheduling_algorithm* const algorithms[], uint32_t algorithm_count);
+
+#endif
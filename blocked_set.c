@@ -0,0 +1,85 @@
+#include "blocked_set.h"
+
+#include <stdlib.h>
+
+int blocked_set_init(_blocked_set* set, uint32_t capacity)
+{
+    (*set).entries = malloc((capacity ? capacity : 1) * sizeof(_blocked_entry));
+    (*set).capacity = capacity ? capacity : 1;
+    (*set).length = (*set).sequence = 0;
+    return (*set).entries ? 0 : -1;
+}
+
+void blocked_set_free(_blocked_set* set)
+{
+    free((*set).entries);
+    (*set).entries = NULL;
+    (*set).capacity = (*set).length = (*set).sequence = 0;
+}
+
+int blocked_set_grow(_blocked_set* set, uint32_t capacity)
+{
+    if (capacity <= (*set).capacity){
+        return 0;
+    }
+    _blocked_entry* entries = realloc((*set).entries, (size_t) capacity * sizeof(_blocked_entry));
+    if (!entries){
+        return -1;
+    }
+    (*set).entries = entries;
+    (*set).capacity = capacity;
+    return 0;
+}
+
+/**
+ * True when a wakes before b
+ */
+static inline int entry_before(const _blocked_entry* a, const _blocked_entry* b)
+{
+    if ((*a).wakeCycle != (*b).wakeCycle){
+        return (*a).wakeCycle < (*b).wakeCycle;
+    }
+    return (*a).sequence < (*b).sequence;
+}
+
+void blocked_set_push(_blocked_set* set, uint32_t wake_cycle, uint32_t process_indx)
+{
+    _blocked_entry entry = { wake_cycle, (*set).sequence++, process_indx };
+    uint32_t i = (*set).length++;
+
+    while (i > 0){
+        uint32_t parent = (i - 1) / 2;
+        if (!entry_before(&entry, &(*set).entries[parent])){
+            break;
+        }
+        (*set).entries[i] = (*set).entries[parent];
+        i = parent;
+    }
+    (*set).entries[i] = entry;
+}
+
+uint32_t blocked_set_pop(_blocked_set* set)
+{
+    uint32_t process_indx = (*set).entries[0].processID;
+    _blocked_entry last = (*set).entries[--(*set).length];
+    uint32_t i = 0;
+
+    while (1){
+        uint32_t child = 2 * i + 1;
+        if (child >= (*set).length){
+            break;
+        }
+        if (child + 1 < (*set).length && entry_before(&(*set).entries[child + 1], &(*set).entries[child])){
+            child++;
+        }
+        if (!entry_before(&(*set).entries[child], &last)){
+            break;
+        }
+        (*set).entries[i] = (*set).entries[child];
+        i = child;
+    }
+    if ((*set).length > 0){
+        (*set).entries[i] = last;
+    }
+    return process_indx;
+}
@@ -0,0 +1,42 @@
+#ifndef BLOCKED_SET_H
+#define BLOCKED_SET_H
+
+#include <stdint.h>
+
+/* A blocked process and the cycle its I/O completes on */
+typedef struct BlockedEntry {
+    uint32_t wakeCycle;                 // The cycle the process finishes being blocked
+    uint32_t sequence;                  // Order of blocking, so processes waking together leave first-in first-out
+    uint32_t processID;                 // The process index
+} _blocked_entry;
+
+/* Binary min-heap of blocked processes ordered on (wakeCycle, sequence) */
+typedef struct BlockedSet {
+    _blocked_entry* entries;            // entries[0] is the next process to wake
+    uint32_t capacity;                  // The number of entries allocated
+    uint32_t length;                    // The number of blocked processes
+    uint32_t sequence;                  // The sequence number given to the next blocked process
+} _blocked_set;
+
+/**
+ * Allocates room for capacity processes. Returns 0 on success, -1 if the allocation fails.
+ */
+int blocked_set_init(_blocked_set* set, uint32_t capacity);
+void blocked_set_free(_blocked_set* set);
+
+/**
+ * Makes room for capacity processes, keeping the blocked ones. Returns 0 on success, -1 if the allocation fails.
+ */
+int blocked_set_grow(_blocked_set* set, uint32_t capacity);
+
+/**
+ * Adds process_indx to the set, waking on wake_cycle
+ */
+void blocked_set_push(_blocked_set* set, uint32_t wake_cycle, uint32_t process_indx);
+
+/**
+ * Removes and returns the index of the next process to wake. The set must not be empty.
+ */
+uint32_t blocked_set_pop(_blocked_set* set);
+
+#endif
@@ -0,0 +1,226 @@
+#include "checkpoint.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "batch.h"
+
+#define CHECKPOINT_TEMPORARY_SUFFIX ".tmp" // A snapshot is written here, then renamed over the last one
+
+/**
+ * FNV-1a over the bytes of the count specs
+ */
+static uint64_t hash_specs(const _process_spec specs[], uint32_t count)
+{
+    const unsigned char* bytes = (const unsigned char*) specs;
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < (size_t) count * sizeof(_process_spec); i++){
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * The first multiple of (*checkpoint).interval after cycle, or UINT32_MAX when there is none or nowhere to save
+ */
+static uint32_t next_snapshot_cycle(const _checkpoint* checkpoint, uint32_t cycle)
+{
+    uint64_t next = ((uint64_t) cycle / (*checkpoint).interval + 1) * (*checkpoint).interval;
+    return (*checkpoint).savePath && next < UINT32_MAX ? (uint32_t) next : UINT32_MAX;
+}
+
+void checkpoint_init(_checkpoint* checkpoint, const char* save_path, const char* resume_path, uint32_t interval,
+                     const char* algorithm_key, const _process_spec specs[], uint32_t count)
+{
+    memset(checkpoint, 0, sizeof(*checkpoint));
+    (*checkpoint).savePath = save_path;
+    (*checkpoint).resumePath = resume_path;
+    (*checkpoint).interval = interval ? interval : CHECKPOINT_DEFAULT_INTERVAL;
+    (*checkpoint).algorithmKey = algorithm_key;
+    (*checkpoint).inputHash = hash_specs(specs, count);
+    (*checkpoint).nextCycle = next_snapshot_cycle(checkpoint, 0);
+}
+
+int checkpoint_read_header(const char* path, _checkpoint_header* header)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file){
+        return -1;
+    }
+    size_t read = fread(header, sizeof(*header), 1, file);
+    fclose(file);
+    if (read != 1 || memcmp((*header).magic, CHECKPOINT_MAGIC, 4) != 0 || (*header).version != CHECKPOINT_VERSION
+            || (*header).stateSize != sizeof(_process_state) || (*header).statsSize != sizeof(_process_stats)
+            || (*header).histogramSize != sizeof(_histogram)
+            || !memchr((*header).algorithmKey, '\0', CHECKPOINT_KEY_LENGTH)){
+        return -3;
+    }
+    return 0;
+}
+
+// Writing ----------
+
+/**
+ * Writes size bytes of data. Returns 0 on success, -1 if they couldn't all be written.
+ */
+static int write_block(FILE* file, const void* data, size_t size)
+{
+    return size == 0 || fwrite(data, size, 1, file) == 1 ? 0 : -1;
+}
+
+void checkpoint_save(_checkpoint* checkpoint, const _simulation* sim, const _scheduling_policy* policy,
+                     const _policy_queue* ready, const _blocked_set* blocked, uint32_t active)
+{
+    char temporary[BATCH_PATH_LENGTH];
+    _checkpoint_header header;
+    FILE* file = NULL;
+    int status = -1;
+
+    (*checkpoint).nextCycle = next_snapshot_cycle(checkpoint, (*sim).currentCycle);
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, 4);
+    header.version = CHECKPOINT_VERSION;
+    strncpy(header.algorithmKey, (*checkpoint).algorithmKey, CHECKPOINT_KEY_LENGTH - 1);
+    header.inputHash = (*checkpoint).inputHash;
+    header.arenaUsed = (*sim).arena.used;
+    header.processCount = (*sim).totalCreatedProcesses;
+    header.quantum = (*sim).quantum;
+    header.stateSize = sizeof(_process_state);
+    header.statsSize = sizeof(_process_stats);
+    header.histogramSize = sizeof(_histogram);
+    header.currentCycle = (*sim).currentCycle;
+    header.totalStartedProcesses = (*sim).totalStartedProcesses;
+    header.totalFinishedProcesses = (*sim).totalFinishedProcesses;
+    header.totalCyclesSpentBlocked = (*sim).totalCyclesSpentBlocked;
+    header.blockedSinceCycle = (*sim).blockedSinceCycle;
+    header.arrivalCursor = (*sim).arrivals.cursor;
+    header.active = active;
+    header.eventCount = (*sim).eventCount;
+    for (uint32_t level = 0; level < (*policy).fifoLevels; level++){
+        header.fifoLengths[level] = (*ready).fifo[level].length;
+    }
+    header.heapLength = (*policy).usesHeap ? (*ready).heap.length : 0;
+    header.blockedLength = (*blocked).length;
+    header.blockedSequence = (*blocked).sequence;
+
+    if (snprintf(temporary, sizeof(temporary), "%s%s", (*checkpoint).savePath, CHECKPOINT_TEMPORARY_SUFFIX)
+            < (int) sizeof(temporary)){
+        file = fopen(temporary, "wb");
+    }
+    if (file){
+        status = write_block(file, &header, sizeof(header));
+        status |= write_block(file, (*sim).arena.base, (*sim).arena.used);
+        // Each ring goes out front first, in at most two pieces, and comes back unwrapped
+        for (uint32_t level = 0; level < (*policy).fifoLevels; level++){
+            const _ready_queue* fifo = &(*ready).fifo[level];
+            uint32_t first = (*fifo).capacity - (*fifo).head;
+            first = first < (*fifo).length ? first : (*fifo).length;
+            status |= write_block(file, (*fifo).slots + (*fifo).head, (size_t) first * sizeof(uint32_t));
+            status |= write_block(file, (*fifo).slots, (size_t) ((*fifo).length - first) * sizeof(uint32_t));
+        }
+        status |= write_block(file, (*ready).heap.entries, (size_t) header.heapLength * sizeof(_ready_heap_entry));
+        status |= write_block(file, (*blocked).entries, (size_t) (*blocked).length * sizeof(_blocked_entry));
+        status |= fclose(file) == 0 ? 0 : -1;
+        if (status == 0 && rename(temporary, (*checkpoint).savePath) != 0){
+            status = -1;
+        }
+    }
+    if (status != 0){
+        (*checkpoint).status = -1;
+        snprintf((*checkpoint).error, sizeof((*checkpoint).error), "can't write %s", (*checkpoint).savePath);
+        return;
+    }
+    (*checkpoint).snapshots++;
+}
+
+// Resuming ----------
+
+/**
+ * Reads size bytes into data. Returns 0 on success, -1 if there weren't enough.
+ */
+static int read_block(FILE* file, void* data, size_t size)
+{
+    return size == 0 || fread(data, size, 1, file) == 1 ? 0 : -1;
+}
+
+/**
+ * Fails the resume of checkpoint with why. Returns -1.
+ */
+static int resume_failed(_checkpoint* checkpoint, const char* why)
+{
+    (*checkpoint).status = -2;
+    snprintf((*checkpoint).error, sizeof((*checkpoint).error), "%s: %s", (*checkpoint).resumePath, why);
+    return -1;
+}
+
+int checkpoint_resume(_checkpoint* checkpoint, _simulation* sim, const _scheduling_policy* policy,
+                      _policy_queue* ready, _blocked_set* blocked, uint32_t* active)
+{
+    _checkpoint_header header;
+    if (!(*checkpoint).resumePath){
+        return 0;
+    }
+    int status = checkpoint_read_header((*checkpoint).resumePath, &header);
+    if (status == -1){
+        return resume_failed(checkpoint, "can't be read");
+    }
+    if (status != 0){
+        return resume_failed(checkpoint, "not a snapshot this build can resume");
+    }
+    if (strcmp(header.algorithmKey, (*checkpoint).algorithmKey) != 0 || header.quantum != (*sim).quantum){
+        return resume_failed(checkpoint, "taken of another algorithm or quantum");
+    }
+    if (header.processCount != (*sim).totalCreatedProcesses || header.inputHash != (*checkpoint).inputHash
+            || header.arenaUsed != (*sim).arena.used){
+        return resume_failed(checkpoint, "taken of another input");
+    }
+    uint32_t queued = header.heapLength;
+    for (uint32_t level = 0; level < POLICY_MAX_LEVELS; level++){
+        if (header.fifoLengths[level] && (level >= (*policy).fifoLevels
+                                          || header.fifoLengths[level] > (*ready).fifo[level].capacity)){
+            return resume_failed(checkpoint, "ready queues don't fit the algorithm");
+        }
+        queued += header.fifoLengths[level];
+    }
+    if ((header.heapLength && (!(*policy).usesHeap || header.heapLength > (*ready).heap.capacity))
+            || header.blockedLength > (*blocked).capacity || header.arrivalCursor > (*sim).arrivals.count
+            || (header.active != NO_PROCESS && header.active >= header.processCount)){
+        return resume_failed(checkpoint, "corrupt");
+    }
+
+    FILE* file = fopen((*checkpoint).resumePath, "rb");
+    if (!file){
+        return resume_failed(checkpoint, "can't be read");
+    }
+    status = fseek(file, sizeof(header), SEEK_SET) == 0 ? 0 : -1;
+    status |= read_block(file, (*sim).arena.base, header.arenaUsed);
+    for (uint32_t level = 0; level < (*policy).fifoLevels; level++){
+        _ready_queue* fifo = &(*ready).fifo[level];
+        (*fifo).head = 0;
+        (*fifo).length = header.fifoLengths[level];
+        status |= read_block(file, (*fifo).slots, (size_t) (*fifo).length * sizeof(uint32_t));
+    }
+    if ((*policy).usesHeap){
+        (*ready).heap.length = header.heapLength;
+        status |= read_block(file, (*ready).heap.entries, (size_t) header.heapLength * sizeof(_ready_heap_entry));
+    }
+    (*blocked).length = header.blockedLength;
+    (*blocked).sequence = header.blockedSequence;
+    status |= read_block(file, (*blocked).entries, (size_t) header.blockedLength * sizeof(_blocked_entry));
+    fclose(file);
+    if (status != 0){
+        return resume_failed(checkpoint, "truncated");
+    }
+
+    (*ready).length = queued;
+    *active = header.active;
+    (*sim).currentCycle = header.currentCycle;
+    (*sim).totalStartedProcesses = header.totalStartedProcesses;
+    (*sim).totalFinishedProcesses = header.totalFinishedProcesses;
+    (*sim).totalCyclesSpentBlocked = header.totalCyclesSpentBlocked;
+    (*sim).blockedSinceCycle = header.blockedSinceCycle;
+    (*sim).arrivals.cursor = header.arrivalCursor;
+    (*sim).eventCount = header.eventCount;
+    (*checkpoint).nextCycle = next_snapshot_cycle(checkpoint, header.currentCycle);
+    return 0;
+}
@@ -0,0 +1,93 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+
+#include "scheduler.h"
+#include "policy.h"
+
+#define CHECKPOINT_MAGIC "SCCK"         // The first four bytes of every snapshot
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_DEFAULT_INTERVAL 1000000 // Cycles between snapshots unless --checkpoint-every says otherwise
+#define CHECKPOINT_KEY_LENGTH 16        // Bytes kept of the algorithm key, terminator included
+
+/*
+ * A snapshot holds everything the engine needs to carry on from the top of a cycle: a fixed-size header
+ * with the run's counters and what it was a run of, then the run's arena (every process's state and stats,
+ * the completion order and the histograms) as one block, then the ready processes in the order the policy
+ * holds them and the blocked set as it lies in its heap. Each part is written with a single fwrite of
+ * memory that is already contiguous, so taking a snapshot costs about as much as copying the run's tables.
+ * Snapshots are raw memory, so they only resume under a build of the same layout (the header checks the
+ * table sizes). Bursts are drawn from a fixed line per process, so there is no random cursor to save:
+ * the remaining bursts are part of each process's state.
+ */
+
+/* The fixed-size start of a snapshot */
+typedef struct CheckpointHeader {
+    char magic[4];                      // CHECKPOINT_MAGIC
+    uint32_t version;                   // CHECKPOINT_VERSION
+    char algorithmKey[CHECKPOINT_KEY_LENGTH]; // The algorithm the run is of
+    uint64_t inputHash;                 // FNV-1a of the input's process specs
+    uint64_t arenaUsed;                 // The bytes of the run's arena that follow the header
+    uint32_t processCount;              // The processes in the input
+    uint32_t quantum;                   // The run's quantum
+    uint32_t stateSize;                 // sizeof(_process_state) in the build that wrote the snapshot
+    uint32_t statsSize;                 // sizeof(_process_stats) in that build
+    uint32_t histogramSize;             // sizeof(_histogram) in that build
+    uint32_t currentCycle;              // The cycle the run carries on from
+    uint32_t totalStartedProcesses;     // The processes that have started running
+    uint32_t totalFinishedProcesses;    // The processes that have finished
+    uint32_t totalCyclesSpentBlocked;   // The cycles spent blocked up to the last time the blocked set emptied
+    uint32_t blockedSinceCycle;         // The cycle the blocked set last went from empty to non-empty
+    uint32_t arrivalCursor;             // The position of the next arrival in the arrival index
+    uint32_t active;                    // The running process (NO_PROCESS if the CPU is idle)
+    uint64_t eventCount;                // Cycles simulated so far
+    uint32_t fifoLengths[POLICY_MAX_LEVELS]; // The processes queued on each ready FIFO
+    uint32_t heapLength;                // The processes queued on the ready heap
+    uint32_t blockedLength;             // The blocked processes
+    uint32_t blockedSequence;           // The sequence number the next blocked process gets
+} _checkpoint_header;
+
+/* Where a run's snapshots go and the snapshot it starts from */
+struct Checkpoint {
+    const char* savePath;               // The file snapshots are written to (NULL takes none)
+    const char* resumePath;             // The snapshot the run carries on from (NULL starts it at cycle 0)
+    uint32_t interval;                  // Cycles between snapshots
+    uint32_t nextCycle;                 // The first cycle the next snapshot can be taken on (UINT32_MAX: none)
+    const char* algorithmKey;           // The algorithm the run is of
+    uint64_t inputHash;                 // FNV-1a of the run's process specs
+    uint32_t snapshots;                 // Snapshots written so far
+    int status;                         // 0, -1 once a snapshot couldn't be written, -2 if the resumed one can't be used
+    char error[128];                    // Why status is not 0
+};
+
+/**
+ * Sets checkpoint up for a run of algorithm_key over the count processes in specs, snapshotting to save_path
+ * every interval cycles and carrying on from resume_path (either path can be NULL)
+ */
+void checkpoint_init(_checkpoint* checkpoint, const char* save_path, const char* resume_path, uint32_t interval,
+                     const char* algorithm_key, const _process_spec specs[], uint32_t count);
+
+/**
+ * Reads the header of the snapshot in path. Returns 0 on success, -1 if path can't be read,
+ * -3 if it is not a snapshot this build can resume.
+ */
+int checkpoint_read_header(const char* path, _checkpoint_header* header);
+
+/**
+ * Loads the run, its ready and blocked processes and its running process from (*checkpoint).resumePath,
+ * if there is one, into a run set up by simulation_init and empty queues. Returns 0 on success (or with
+ * nothing to resume), -1 with (*checkpoint).status and error set if the snapshot can't be used.
+ */
+int checkpoint_resume(_checkpoint* checkpoint, _simulation* sim, const _scheduling_policy* policy,
+                      _policy_queue* ready, _blocked_set* blocked, uint32_t* active);
+
+/**
+ * Writes the run as it stands at the top of (*sim).currentCycle to (*checkpoint).savePath, replacing the
+ * previous snapshot only once the new one is complete, and schedules the next one.
+ * A snapshot that can't be written sets (*checkpoint).status and error; the run carries on.
+ */
+void checkpoint_save(_checkpoint* checkpoint, const _simulation* sim, const _scheduling_policy* policy,
+                     const _policy_queue* ready, const _blocked_set* blocked, uint32_t active);
+
+#endif
@@ -0,0 +1,318 @@
+#include "ensemble.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scheduler.h"
+#include "policy.h"
+#include "smp.h"
+#include "thread_pool.h"
+
+/* The summary metrics of every variant, in the order printSummaryData prints them */
+enum {
+    METRIC_FINISHING_TIME,
+    METRIC_CPU_UTILISATION,
+    METRIC_IO_UTILISATION,
+    METRIC_THROUGHPUT,
+    METRIC_TURNAROUND,
+    METRIC_WAITING,
+    ENSEMBLE_METRIC_COUNT
+};
+
+static const char* const METRIC_NAMES[ENSEMBLE_METRIC_COUNT] = {
+    "Finishing time", "CPU Utilisation", "I/O Utilisation", "Throughput", "Average turnaround time",
+    "Average waiting time"
+};
+
+/* The input every variant is derived from, shared read-only by the jobs */
+typedef struct Ensemble {
+    const _process_spec* processes;     // The parsed input (variant 0)
+    uint32_t processCount;              // The number of processes
+    const _arrival_index* arrivals;     // The arrival order; no variant changes an arrival time
+    const _random_source* randomSource; // The random table, read from SEED_VALUE by variant 0
+    _ensemble_vary vary;                // What the variants differ in
+    uint32_t cpuCount;                  // The simulated CPUs of every run (0 runs the uniprocessor engines)
+} _ensemble;
+
+/* One algorithm and quantum over every variant. Each metric is laid out as one lane per variant. */
+typedef struct EnsembleRun {
+    const _scheduling_algorithm* algorithm; // The algorithm simulated
+    uint32_t quantum;                   // The quantum it ran with
+    double* metrics[ENSEMBLE_METRIC_COUNT]; // metrics[m][v] is metric m of variant v
+} _ensemble_run;
+
+/* One variant of one run, simulated on a worker */
+typedef struct EnsembleJob {
+    const _ensemble* ensemble;          // The input the variant is derived from
+    _ensemble_run* run;                 // Where the variant's metrics go
+    uint32_t variant;                   // The variant's index (its lane)
+    int status;                         // 0 once the metrics are in, -1 if the run couldn't be allocated
+} _ensemble_job;
+
+/* The distribution of one metric across the ensemble */
+typedef struct EnsembleStats {
+    double min;
+    double max;
+    double mean;
+    double stddev;                      // Population standard deviation
+    double p50;
+    double p95;
+    double p99;
+} _ensemble_stats;
+
+int parse_ensemble_vary(const char* name, _ensemble_vary* vary)
+{
+    if (strcmp(name, "seed") == 0){
+        *vary = ENSEMBLE_VARY_SEED;
+    }
+    else if (strcmp(name, "b") == 0){
+        *vary = ENSEMBLE_VARY_B;
+    }
+    else if (strcmp(name, "m") == 0){
+        *vary = ENSEMBLE_VARY_M;
+    }
+    else{
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Scales value by 100 + variant * ENSEMBLE_SCALE_STEP percent, rounding to the nearest integer
+ */
+static uint32_t scale(uint32_t value, uint32_t variant)
+{
+    uint64_t scaled = ((uint64_t) value * (100 + (uint64_t) variant * ENSEMBLE_SCALE_STEP) + 50) / 100;
+    return scaled > UINT32_MAX ? UINT32_MAX : (uint32_t) scaled;
+}
+
+static void run_variant(void* argument)
+{
+    _ensemble_job* job = argument;
+    const _ensemble* ensemble = (*job).ensemble;
+    const _scheduling_algorithm* algorithm = (*(*job).run).algorithm;
+    uint32_t variant = (*job).variant;
+    const _process_spec* specs = (*ensemble).processes;
+    _process_spec* scaled = NULL;
+
+    // A seed variant reads the shared table through a view starting variant lines further on
+    _random_source random = *(*ensemble).randomSource;
+    random.mapping = NULL;
+    random.owned = NULL;
+    (*job).status = -1;
+    if ((*ensemble).vary == ENSEMBLE_VARY_SEED){
+        random.numbers += variant < random.count ? variant : random.count;
+        random.count = variant < random.count ? random.count - variant : 0;
+    }
+    else if (variant){
+        scaled = malloc(((*ensemble).processCount ? (*ensemble).processCount : 1) * sizeof(_process_spec));
+        if (!scaled){
+            return;
+        }
+        for (uint32_t i = 0; i < (*ensemble).processCount; i++){
+            scaled[i] = specs[i];
+            if ((*ensemble).vary == ENSEMBLE_VARY_B){
+                scaled[i].B = scale(scaled[i].B, variant);
+            }
+            else{
+                scaled[i].M = scale(scaled[i].M, variant);
+            }
+        }
+        specs = scaled;
+    }
+
+    _simulation sim;
+    if (simulation_init(&sim, specs, (*ensemble).processCount, (*ensemble).arrivals, &random, (*(*job).run).quantum,
+                        (*ensemble).cpuCount) != 0){
+        free(scaled);
+        return;
+    }
+    if ((sim.cpuCount ? smp_simulate(&sim, (*algorithm).policy) : (*algorithm).run(&sim)) != 0){
+        simulation_free(&sim);
+        free(scaled);
+        return;
+    }
+
+    _summary_data summary;
+    double** metrics = (*(*job).run).metrics;
+    compute_summary(&sim, &summary);
+    metrics[METRIC_FINISHING_TIME][variant] = summary.finishingTime;
+    metrics[METRIC_CPU_UTILISATION][variant] = summary.cpuUtilisation;
+    metrics[METRIC_IO_UTILISATION][variant] = summary.ioUtilisation;
+    metrics[METRIC_THROUGHPUT][variant] = summary.throughput;
+    metrics[METRIC_TURNAROUND][variant] = summary.averageTurnaroundTime;
+    metrics[METRIC_WAITING][variant] = summary.averageWaitingTime;
+    simulation_free(&sim);
+    free(scaled);
+    (*job).status = 0;
+}
+
+static int compare_doubles(const void* left, const void* right)
+{
+    double a = *(const double*) left, b = *(const double*) right;
+    return a < b ? -1 : (a > b);
+}
+
+/**
+ * Nearest-rank percentile of count sorted values
+ */
+static double percentile(const double* sorted, uint32_t count, double fraction)
+{
+    uint32_t rank = (uint32_t) ceil(fraction * count);
+    return sorted[rank ? rank - 1 : 0];
+}
+
+/**
+ * Computes the distribution of count lanes, using sorted (room for count values) to rank them.
+ */
+static void ensemble_stats(const double* lanes, uint32_t count, double* sorted, _ensemble_stats* stats)
+{
+    memcpy(sorted, lanes, (size_t) count * sizeof(double));
+    qsort(sorted, count, sizeof(double), compare_doubles);
+    (*stats).min = sorted[0];
+    (*stats).max = sorted[count - 1];
+
+    // Two passes, so the spread is summed around the mean rather than recovered from two large, nearly equal sums
+    double sum = 0, squares = 0;
+    for (uint32_t i = 0; i < count; i++){
+        sum += lanes[i];
+    }
+    (*stats).mean = sum / count;
+    for (uint32_t i = 0; i < count; i++){
+        double deviation = lanes[i] - (*stats).mean;
+        squares += deviation * deviation;
+    }
+    (*stats).stddev = sqrt(squares / count);
+    (*stats).p50 = percentile(sorted, count, 0.50);
+    (*stats).p95 = percentile(sorted, count, 0.95);
+    (*stats).p99 = percentile(sorted, count, 0.99);
+}
+
+/**
+ * Prints every variant's summary row, then the distribution of each metric across them
+ */
+static void print_run(const _ensemble_run* run, const char* input_path, uint32_t variant_count, _ensemble_vary vary,
+                      double* sorted)
+{
+    static const char* const VARY_DESCRIPTIONS[] = { "the random seed", "B", "M" };
+    static const char* const VARY_COLUMNS[] = { "seed", "b_percent", "m_percent" };
+    const _scheduling_algorithm* algorithm = (*run).algorithm;
+
+    printf("\n######################### START OF ENSEMBLE OF %s #########################\n", (*algorithm).banner);
+    printf("%u variants of %s varying %s under %s", variant_count, input_path, VARY_DESCRIPTIONS[vary], (*algorithm).name);
+    if ((*algorithm).usesQuantum){
+        printf(" (quantum %u)", (*run).quantum);
+    }
+    printf("\nvariant,%s,finishing_time,cpu_utilisation,io_utilisation,throughput,average_turnaround,average_waiting\n",
+           VARY_COLUMNS[vary]);
+    for (uint32_t v = 0; v < variant_count; v++){
+        printf("%u,%u,%.0f", v, vary == ENSEMBLE_VARY_SEED ? SEED_VALUE + v : 100 + v * ENSEMBLE_SCALE_STEP,
+               (*run).metrics[METRIC_FINISHING_TIME][v]);
+        for (int m = METRIC_CPU_UTILISATION; m < ENSEMBLE_METRIC_COUNT; m++){
+            printf(",%.6f", (*run).metrics[m][v]);
+        }
+        printf("\n");
+    }
+
+    printf("\nEnsemble Data:\n");
+    for (int m = 0; m < ENSEMBLE_METRIC_COUNT; m++){
+        _ensemble_stats stats;
+        ensemble_stats((*run).metrics[m], variant_count, sorted, &stats);
+        printf("\t%s: min %.6f p50 %.6f p95 %.6f p99 %.6f max %.6f mean %.6f stddev %.6f\n", METRIC_NAMES[m],
+               stats.min, stats.p50, stats.p95, stats.p99, stats.max, stats.mean, stats.stddev);
+    }
+    printf("######################### END OF ENSEMBLE OF %s #########################\n", (*algorithm).banner);
+}
+
+int run_ensemble(const char* input_path, const _batch_config* config, uint32_t variant_count, _ensemble_vary vary)
+{
+    _process_spec* processes;
+    _arrival_index arrivals;
+    _random_source randomSource;
+    uint32_t count;
+    char load_error[128];
+
+    int loaded = load_processes(input_path, &processes, &count, load_error, sizeof(load_error));
+    if (loaded == -1){
+        printf("%s not found\n", input_path);
+        return -1;
+    }
+    else if (loaded == -3){
+        printf("%s: %s\n", input_path, load_error);
+        return -1;
+    }
+    else if (loaded != 0){
+        printf("Out of memory loading %s\n", input_path);
+        return -1;
+    }
+    if (random_source_load(&randomSource, RANDOM_NUMBER_FILE_NAME) != 0){
+        printf("%s not found\n", RANDOM_NUMBER_FILE_NAME);
+        free(processes);
+        return -1;
+    }
+    if (build_arrival_index(processes, count, &arrivals) != 0){
+        printf("Out of memory indexing %i processes\n", count);
+        random_source_free(&randomSource);
+        free(processes);
+        return -1;
+    }
+
+    _ensemble ensemble = { processes, count, &arrivals, &randomSource, vary, (*config).cpuCount };
+    uint32_t run_count = 0;
+    _ensemble_run* runs = calloc((size_t) (*config).algorithmCount * (*config).quantumCount, sizeof(_ensemble_run));
+    double* lanes = malloc((size_t) (*config).algorithmCount * (*config).quantumCount * ENSEMBLE_METRIC_COUNT
+                           * variant_count * sizeof(double));
+    double* sorted = malloc((size_t) variant_count * sizeof(double));
+    _ensemble_job* jobs = malloc((size_t) (*config).algorithmCount * (*config).quantumCount * variant_count
+                                 * sizeof(_ensemble_job));
+    int status = runs && lanes && sorted && jobs ? 0 : -1;
+
+    // Every (algorithm, quantum) run gets its lanes, then every variant of every run is queued ----------
+
+    for (uint32_t i = 0; i < (*config).algorithmCount && status == 0; i++){
+        const _scheduling_algorithm* algorithm = (*config).algorithms[i];
+        for (uint32_t k = 0; k < ((*algorithm).usesQuantum ? (*config).quantumCount : 1); k++){
+            _ensemble_run* run = &runs[run_count];
+            (*run).algorithm = algorithm;
+            (*run).quantum = (*algorithm).usesQuantum ? (*config).quanta[k] : QUANTUM;
+            for (int m = 0; m < ENSEMBLE_METRIC_COUNT; m++){
+                (*run).metrics[m] = lanes + ((size_t) run_count * ENSEMBLE_METRIC_COUNT + m) * variant_count;
+            }
+            for (uint32_t v = 0; v < variant_count; v++){
+                jobs[(size_t) run_count * variant_count + v] = (_ensemble_job) { &ensemble, run, v, -1 };
+            }
+            run_count++;
+        }
+    }
+    size_t job_count = (size_t) run_count * variant_count;
+    _thread_pool* pool = status == 0 ? thread_pool_create((*config).threadCount) : NULL;
+    for (size_t j = 0; j < job_count; j++){
+        if (!pool || thread_pool_submit(pool, run_variant, &jobs[j]) != 0){
+            run_variant(&jobs[j]);
+        }
+    }
+    thread_pool_destroy(pool);
+    for (size_t j = 0; j < job_count && status == 0; j++){
+        status = jobs[j].status;
+    }
+
+    if (status == 0){
+        for (uint32_t r = 0; r < run_count; r++){
+            print_run(&runs[r], input_path, variant_count, vary, sorted);
+        }
+    }
+    else{
+        printf("Out of memory simulating %u variants of %i processes\n", variant_count, count);
+    }
+
+    free(jobs);
+    free(sorted);
+    free(lanes);
+    free(runs);
+    free((void*) arrivals.order);
+    random_source_free(&randomSource);
+    free(processes);
+    return status;
+}
@@ -0,0 +1,31 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <stdint.h>
+
+#include "batch.h"
+
+#define ENSEMBLE_MAX_VARIANTS 65536
+#define ENSEMBLE_SCALE_STEP 5           // Percent each B or M variant scales its multiplier by over the one before
+
+/* What the variants of an ensemble differ in */
+typedef enum {
+    ENSEMBLE_VARY_SEED,                 // Variant v reads the random numbers from SEED_VALUE + v
+    ENSEMBLE_VARY_B,                    // Variant v scales every B by 100 + v * ENSEMBLE_SCALE_STEP percent
+    ENSEMBLE_VARY_M                     // Variant v scales every M by 100 + v * ENSEMBLE_SCALE_STEP percent
+} _ensemble_vary;
+
+/**
+ * Parses seed, b or m into vary. Returns 0 on success, -1 if name is none of them.
+ */
+int parse_ensemble_vary(const char* name, _ensemble_vary* vary);
+
+/**
+ * Simulates variant_count variants of input_path (variant 0 is the input itself) under every algorithm and
+ * quantum in config, on (*config).threadCount workers and (*config).cpuCount CPUs. Prints one summary row per
+ * variant and the distribution of every summary metric across the ensemble to stdout.
+ * Returns 0 on success, -1 if the input or the random numbers can't be used or memory runs out.
+ */
+int run_ensemble(const char* input_path, const _batch_config* config, uint32_t variant_count, _ensemble_vary vary);
+
+#endif
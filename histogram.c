@@ -0,0 +1,104 @@
+#include "histogram.h"
+
+#include <math.h>
+#include <string.h>
+
+#define HISTOGRAM_BAR_WIDTH 40          // The '#'s drawn for the fullest range
+
+void histogram_init(_histogram* histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+    (*histogram).min = UINT32_MAX;
+}
+
+/**
+ * The smallest value that falls in bucket
+ */
+static uint32_t bucket_low(uint32_t bucket)
+{
+    if (bucket < (1u << HISTOGRAM_SUB_BUCKET_BITS)){
+        return bucket;
+    }
+    uint32_t shift = (bucket >> (HISTOGRAM_SUB_BUCKET_BITS - 1)) - 1;
+    return (bucket - (shift << (HISTOGRAM_SUB_BUCKET_BITS - 1))) << shift;
+}
+
+/**
+ * The largest value that falls in bucket
+ */
+static uint32_t bucket_high(uint32_t bucket)
+{
+    return bucket + 1 < HISTOGRAM_BUCKET_COUNT ? bucket_low(bucket + 1) - 1 : UINT32_MAX;
+}
+
+uint32_t histogram_percentile(const _histogram* histogram, double fraction)
+{
+    if (!(*histogram).total){
+        return 0;
+    }
+    uint64_t rank = (uint64_t) ceil(fraction * (*histogram).total);
+    rank = rank ? rank : 1;
+    uint64_t seen = 0;
+    uint32_t bucket = 0;
+    for (; bucket < HISTOGRAM_BUCKET_COUNT; bucket++){
+        seen += (*histogram).counts[bucket];
+        if (seen >= rank){
+            break;
+        }
+    }
+    uint32_t high = bucket_high(bucket);
+    return high < (*histogram).max ? high : (*histogram).max;
+}
+
+void printPercentiles(const _histogram* histogram, const char* label, _report_writer* out)
+{
+    static const double FRACTIONS[] = { 0.50, 0.90, 0.95, 0.99, 0.999 };
+    static const char* const NAMES[] = { "p50", "p90", "p95", "p99", "p99.9" };
+
+    report_char(out, '\t');
+    report_text(out, label);
+    report_char(out, ':');
+    for (uint32_t i = 0; i < sizeof(FRACTIONS) / sizeof(FRACTIONS[0]); i++){
+        report_char(out, ' ');
+        report_text(out, NAMES[i]);
+        report_char(out, ' ');
+        report_uint(out, histogram_percentile(histogram, FRACTIONS[i]));
+    }
+    report_text(out, " max ");
+    report_uint(out, (*histogram).max);
+    report_char(out, '\n');
+}
+
+void printHistogram(const _histogram* histogram, const char* label, _report_writer* out)
+{
+    uint32_t ranges[33] = { 0 };        // ranges[0] counts 0, ranges[k] counts [2^(k-1), 2^k)
+    uint32_t fullest = 0;
+    for (uint32_t bucket = 0; bucket < HISTOGRAM_BUCKET_COUNT; bucket++){
+        uint32_t low = bucket_low(bucket);
+        ranges[low ? 32 - __builtin_clz(low) : 0] += (*histogram).counts[bucket];
+    }
+    for (uint32_t k = 0; k < 33; k++){
+        fullest = ranges[k] > fullest ? ranges[k] : fullest;
+    }
+
+    report_char(out, '\t');
+    report_text(out, label);
+    report_text(out, " histogram:\n");
+    for (uint32_t k = 0; k < 33; k++){
+        if (!ranges[k]){
+            continue;
+        }
+        report_text(out, "\t\t[");
+        report_uint(out, k ? 1ull << (k - 1) : 0);
+        report_text(out, ", ");
+        report_uint(out, k ? 1ull << k : 1);
+        report_text(out, "): ");
+        report_uint(out, ranges[k]);
+        report_char(out, ' ');
+        uint32_t width = (uint32_t) ((uint64_t) ranges[k] * HISTOGRAM_BAR_WIDTH / fullest);
+        for (uint32_t i = 0; i < (width ? width : 1); i++){
+            report_char(out, '#');
+        }
+        report_char(out, '\n');
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+#include "report_writer.h"
+
+/*
+ * A fixed-size log-linear histogram of cycle counts, in the style of HdrHistogram. Values below
+ * 2^HISTOGRAM_SUB_BUCKET_BITS get a bucket each; every power of two above that is split into
+ * 2^(HISTOGRAM_SUB_BUCKET_BITS - 1) equal buckets, so a recorded value is known to within 1/64 of
+ * itself whatever its size, and a run of any length fits in the same few kilobytes.
+ */
+
+#define HISTOGRAM_SUB_BUCKET_BITS 7
+#define HISTOGRAM_BUCKET_COUNT (((32 - HISTOGRAM_SUB_BUCKET_BITS) << (HISTOGRAM_SUB_BUCKET_BITS - 1)) \
+                                + (1 << HISTOGRAM_SUB_BUCKET_BITS))
+
+typedef struct Histogram {
+    uint32_t counts[HISTOGRAM_BUCKET_COUNT]; // Recorded values per bucket
+    uint32_t total;                     // Recorded values
+    uint32_t min;                       // The smallest value recorded (UINT32_MAX while empty)
+    uint32_t max;                       // The largest value recorded
+} _histogram;
+
+void histogram_init(_histogram* histogram);
+
+/**
+ * The bucket value falls in
+ */
+static inline uint32_t histogram_bucket(uint32_t value)
+{
+    if (value < (1u << HISTOGRAM_SUB_BUCKET_BITS)){
+        return value;
+    }
+    uint32_t shift = (31 - __builtin_clz(value)) - (HISTOGRAM_SUB_BUCKET_BITS - 1);
+    return (shift << (HISTOGRAM_SUB_BUCKET_BITS - 1)) + (value >> shift);
+}
+
+static inline void histogram_record(_histogram* histogram, uint32_t value)
+{
+    (*histogram).counts[histogram_bucket(value)]++;
+    (*histogram).total++;
+    (*histogram).min = value < (*histogram).min ? value : (*histogram).min;
+    (*histogram).max = value > (*histogram).max ? value : (*histogram).max;
+}
+
+/**
+ * The value at or below which fraction of the recorded values lie (nearest rank), as the highest value
+ * of its bucket, never above the largest value recorded. Returns 0 while the histogram is empty.
+ */
+uint32_t histogram_percentile(const _histogram* histogram, double fraction);
+
+/**
+ * Writes the percentiles of histogram, labelled label, as one line of a report block
+ */
+void printPercentiles(const _histogram* histogram, const char* label, _report_writer* out);
+
+/**
+ * Writes histogram folded into power-of-two ranges, one line with a bar per non-empty range
+ */
+void printHistogram(const _histogram* histogram, const char* label, _report_writer* out);
+
+#endif
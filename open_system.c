@@ -0,0 +1,466 @@
+#include "open_system.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "policy.h"
+#include "workload_reader.h"
+
+/* The metrics of the current rolling window, as counted since it opened */
+typedef struct OpenWindow {
+    uint32_t startCycle;                // The last cycle of the previous window (0 for the first)
+    uint32_t arrived;                   // Processes that arrived in the window
+    uint32_t finished;                  // Processes that finished in the window
+    uint64_t busyCycles;                // The run's busy cycles when the window opened
+    uint64_t blockedCycles;             // The run's I/O-busy cycles when the window opened
+    uint64_t turnaround;                // Turnaround time of the processes that finished in the window
+    uint64_t waiting;                   // Waiting time of the processes that finished in the window
+    _histogram turnaroundHistogram;     // Turnaround time of the processes that finished in the window
+} _open_window;
+
+/* An open-system run: the live processes, indexed by slot, and the stream they come from */
+typedef struct OpenSystem {
+    _simulation sim;                    // Its specs, states and stats are indexed by slot
+    _process_spec* specs;               // sim.specs, writable
+    uint32_t* randomIndex;              // sim.randomIndex: the stream position of each slot's process, wrapped
+    uint32_t* freeSlots;                // A min-heap of free slots, so the lowest is reused first
+    uint32_t freeCount;                 // The number of free slots
+    uint32_t capacity;                  // The number of slots allocated
+    const _scheduling_policy* policy;   // The policy the run is scheduled under
+    _policy_queue ready;                // The ready processes
+    _blocked_set blocked;               // The processes blocked on I/O
+
+    _workload_reader reader;            // The arrival stream
+    _process_spec next;                 // The next process of the stream, read ahead (valid while hasNext)
+    bool hasNext;                       // Whether the stream has another process
+    uint32_t randomPeriod;              // Stream positions wrap round the random table after this many
+
+    uint32_t arrived;                   // Processes read from the stream so far
+    uint32_t live;                      // Processes that have arrived and not finished
+    uint32_t peakLive;                  // The most processes live at once
+    uint64_t busyCycles;                // Cycles a process was running
+    uint64_t turnaround;                // Turnaround time of every finished process
+    uint64_t waiting;                   // Waiting time of every finished process
+    uint32_t window;                    // Cycles per window
+    _open_window current;               // The window being counted
+} _open_system;
+
+// The free list ----------
+
+static void free_slot(_open_system* open, uint32_t slot)
+{
+    uint32_t i = (*open).freeCount++;
+    while (i > 0 && (*open).freeSlots[(i - 1) / 2] > slot){
+        (*open).freeSlots[i] = (*open).freeSlots[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    (*open).freeSlots[i] = slot;
+}
+
+static uint32_t take_slot(_open_system* open)
+{
+    uint32_t slot = (*open).freeSlots[0];
+    uint32_t last = (*open).freeSlots[--(*open).freeCount];
+    uint32_t i = 0;
+    while (1){
+        uint32_t child = 2 * i + 1;
+        if (child >= (*open).freeCount){
+            break;
+        }
+        if (child + 1 < (*open).freeCount && (*open).freeSlots[child + 1] < (*open).freeSlots[child]){
+            child++;
+        }
+        if ((*open).freeSlots[child] >= last){
+            break;
+        }
+        (*open).freeSlots[i] = (*open).freeSlots[child];
+        i = child;
+    }
+    if ((*open).freeCount){
+        (*open).freeSlots[i] = last;
+    }
+    return slot;
+}
+
+/**
+ * Doubles the slots, and the queues that hold them, once every slot is live.
+ * Returns 0 on success, -1 if memory runs out.
+ */
+static int grow_slots(_open_system* open)
+{
+    uint32_t capacity = (*open).capacity ? (*open).capacity * 2 : OPEN_INITIAL_SLOTS;
+    if (capacity <= (*open).capacity){
+        return -1;
+    }
+    _process_spec* specs = realloc((*open).specs, (size_t) capacity * sizeof(_process_spec));
+    if (specs){
+        (*open).specs = specs;
+    }
+    _process_state* states = realloc((*open).sim.states, (size_t) capacity * sizeof(_process_state));
+    if (states){
+        (*open).sim.states = states;
+    }
+    _process_stats* stats = realloc((*open).sim.stats, (size_t) capacity * sizeof(_process_stats));
+    if (stats){
+        (*open).sim.stats = stats;
+    }
+    uint32_t* random_index = realloc((*open).randomIndex, (size_t) capacity * sizeof(uint32_t));
+    if (random_index){
+        (*open).randomIndex = random_index;
+    }
+    uint32_t* free_slots = realloc((*open).freeSlots, (size_t) capacity * sizeof(uint32_t));
+    if (free_slots){
+        (*open).freeSlots = free_slots;
+    }
+    (*open).sim.specs = (*open).specs;
+    (*open).sim.randomIndex = (*open).randomIndex;
+    if (!specs || !states || !stats || !random_index || !free_slots
+            || policy_queue_grow(&(*open).ready, (*open).policy, capacity) != 0
+            || blocked_set_grow(&(*open).blocked, capacity) != 0){
+        return -1;
+    }
+
+    // Every slot is taken, so the new ones, in order, already form a min-heap
+    for (uint32_t slot = (*open).capacity; slot < capacity; slot++){
+        (*open).freeSlots[(*open).freeCount++] = slot;
+    }
+    (*open).capacity = capacity;
+    return 0;
+}
+
+// The arrival stream ----------
+
+/**
+ * Reads the process after the one just taken. Returns 0 on success, -1 if the stream is malformed.
+ */
+static int read_ahead(_open_system* open, const char* input_path)
+{
+    uint32_t previous = (*open).next.A;
+    int read = workload_reader_next(&(*open).reader, &(*open).next);
+    if (read < 0){
+        printf("%s: line %u: %s\n", input_path, (*open).reader.line, (*open).reader.error);
+        return -1;
+    }
+    (*open).hasNext = read == 1;
+    if ((*open).hasNext && (*open).arrived && (*open).next.A < previous){
+        printf("%s: line %u: arrival times must not decrease in a stream\n", input_path, (*open).reader.line);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Gives the next process of the stream a slot if it arrives on (*sim).currentCycle.
+ * Returns its slot, NO_PROCESS once nothing else arrives this cycle, or -1 through *status on failure.
+ */
+static uint32_t next_stream_arrival(_open_system* open, const char* input_path, int* status)
+{
+    _simulation* sim = &(*open).sim;
+    if (!(*open).hasNext || (*open).next.A > (*sim).currentCycle){
+        return NO_PROCESS;
+    }
+    if (!(*open).freeCount && grow_slots(open) != 0){
+        printf("Out of memory simulating %u live processes\n", (*open).live + 1);
+        *status = -1;
+        return NO_PROCESS;
+    }
+    uint32_t slot = take_slot(open);
+    (*open).specs[slot] = (*open).next;
+    (*open).randomIndex[slot] = (*open).randomPeriod ? (*open).arrived % (*open).randomPeriod : (*open).arrived;
+    initialize_process(sim, slot);
+    (*open).arrived++;
+    (*open).current.arrived++;
+    (*sim).totalCreatedProcesses++;
+    if (++(*open).live > (*open).peakLive){
+        (*open).peakLive = (*open).live;
+    }
+    if (read_ahead(open, input_path) != 0){
+        *status = -1;
+    }
+    return slot;
+}
+
+/**
+ * Records the process in slot finishing on (*sim).currentCycle and hands its slot back
+ */
+static void stream_finished(_open_system* open, uint32_t slot)
+{
+    _simulation* sim = &(*open).sim;
+    uint32_t turnaround = (*sim).currentCycle - (*open).specs[slot].A;
+    uint32_t waiting = (*sim).stats[slot].currentWaitingTime;
+
+    (*sim).states[slot].status = 4;
+    (*sim).totalFinishedProcesses++;
+    (*open).turnaround += turnaround;
+    (*open).waiting += waiting;
+    histogram_record((*sim).turnaroundHistogram, turnaround);
+    histogram_record((*sim).waitingHistogram, waiting);
+    (*open).current.finished++;
+    (*open).current.turnaround += turnaround;
+    (*open).current.waiting += waiting;
+    histogram_record(&(*open).current.turnaroundHistogram, turnaround);
+    (*open).live--;
+    free_slot(open, slot);
+}
+
+// Windows ----------
+
+/**
+ * The cycles up to and including (*sim).currentCycle in which at least one process was blocked
+ */
+static uint64_t blocked_cycles(const _open_system* open)
+{
+    const _simulation* sim = &(*open).sim;
+    return (*sim).totalCyclesSpentBlocked
+           + ((*open).blocked.length ? (*sim).currentCycle - (*sim).blockedSinceCycle : 0);
+}
+
+/**
+ * Prints the row of the window ending with (*sim).currentCycle and opens the next one
+ */
+static void close_window(_open_system* open)
+{
+    _simulation* sim = &(*open).sim;
+    _open_window* window = &(*open).current;
+    uint32_t length = (*sim).currentCycle - (*window).startCycle;
+    uint64_t blocked = blocked_cycles(open);
+
+    printf("%u,%u,%u,%u,%u,%u,%.6f,%.6f,%.6f,", (*sim).currentCycle, (*window).arrived, (*window).finished,
+           (*open).live, (*open).ready.length, (*open).blocked.length,
+           (double) ((*open).busyCycles - (*window).busyCycles) / length,
+           (double) (blocked - (*window).blockedCycles) / length, 100 * ((double) (*window).finished / length));
+    if ((*window).finished){
+        printf("%.6f,%.6f,%u,%u,%u\n", (double) (*window).turnaround / (*window).finished,
+               (double) (*window).waiting / (*window).finished,
+               histogram_percentile(&(*window).turnaroundHistogram, 0.50),
+               histogram_percentile(&(*window).turnaroundHistogram, 0.95),
+               histogram_percentile(&(*window).turnaroundHistogram, 0.99));
+    }
+    else{
+        printf(",,,,\n");
+    }
+
+    memset(window, 0, sizeof(*window));
+    histogram_init(&(*window).turnaroundHistogram);
+    (*window).startCycle = (*sim).currentCycle;
+    (*window).busyCycles = (*open).busyCycles;
+    (*window).blockedCycles = blocked;
+}
+
+// The engine ----------
+
+/**
+ * skip_to_next_event for a stream: the next arrival is the one read ahead, and every window boundary is an
+ * event of its own, so no jump crosses one and each window's counts stay exact
+ */
+static void skip_ahead(_open_system* open, uint32_t active)
+{
+    _simulation* sim = &(*open).sim;
+    _process_state* state = active != NO_PROCESS ? &(*sim).states[active] : NULL;
+    uint32_t last_cycle = (*sim).currentCycle - 1;
+    uint32_t next_cycle = UINT32_MAX;
+
+    if ((*open).hasNext){
+        next_cycle = (*open).next.A;
+    }
+    if ((*open).blocked.length && (*open).blocked.entries[0].wakeCycle < next_cycle){
+        next_cycle = (*open).blocked.entries[0].wakeCycle;
+    }
+    if (state){
+        if (last_cycle + (*state).CPUBurst < next_cycle){
+            next_cycle = last_cycle + (*state).CPUBurst;
+        }
+        if ((*(*open).policy).nextDecision){
+            uint32_t decision = (*(*open).policy).nextDecision(sim, &(*open).ready, active);
+            next_cycle = decision < next_cycle ? decision : next_cycle;
+        }
+    }
+    if (next_cycle <= (*sim).currentCycle || next_cycle == UINT32_MAX){
+        return;
+    }
+    uint64_t boundary = ((uint64_t) (*sim).currentCycle + (*open).window - 1) / (*open).window * (*open).window;
+    if (boundary < next_cycle){
+        next_cycle = (uint32_t) boundary;
+    }
+    if (next_cycle <= (*sim).currentCycle){
+        return;
+    }
+
+    uint32_t skipped = next_cycle - (*sim).currentCycle;
+    if (state){
+        (*state).CPUBurst -= skipped;
+        (*state).currentCPUTimeRun += skipped;
+        (*open).busyCycles += skipped;
+        if ((*(*open).policy).timeSliced){
+            (*state).quantum -= skipped;
+        }
+    }
+    (*sim).currentCycle = next_cycle;
+}
+
+/**
+ * The cycle loop of simulate, with arrivals taken from the stream and finished processes giving up their slots.
+ * Returns 0 once the stream has ended and every process has finished, -1 if the run had to stop.
+ */
+static int run_stream(_open_system* open, const char* input_path)
+{
+    _simulation* sim = &(*open).sim;
+    const _scheduling_policy* policy = (*open).policy;
+    uint32_t active = NO_PROCESS, current;
+    int status = 0;
+
+    while ((*open).hasNext || (*open).live){
+        while ((current = next_unblocked(sim, &(*open).blocked)) != NO_PROCESS){
+            make_ready(sim, policy, &(*open).ready, current);
+        }
+        while ((current = next_stream_arrival(open, input_path, &status)) != NO_PROCESS){
+            make_ready(sim, policy, &(*open).ready, current);
+        }
+        if (status != 0){
+            return status;
+        }
+        if (active != NO_PROCESS){
+            _process_state* state = &(*sim).states[active];
+            (*state).CPUBurst -= 1;
+            (*state).currentCPUTimeRun += 1;
+            (*open).busyCycles += 1;
+            if ((*policy).timeSliced){
+                (*state).quantum -= 1;
+            }
+            if ((*state).currentCPUTimeRun == (*sim).specs[active].C){
+                (*sim).stats[active].finishingTime = (*sim).currentCycle;
+                stream_finished(open, active);
+                active = NO_PROCESS;
+            }
+            else if ((*state).CPUBurst == 0){
+                block(sim, active, &(*open).blocked);
+                active = NO_PROCESS;
+            }
+            else if ((*policy).preempt && (*policy).preempt(sim, &(*open).ready, active)){
+                make_ready(sim, policy, &(*open).ready, active);
+                active = NO_PROCESS;
+            }
+        }
+        if ((*open).ready.length && active == NO_PROCESS){
+            active = pick_next(sim, policy, &(*open).ready);
+            start_process(sim, active);
+        }
+        if ((*sim).currentCycle && (*sim).currentCycle % (*open).window == 0){
+            close_window(open);
+        }
+        (*sim).currentCycle += 1;
+        (*sim).eventCount += 1;
+        skip_ahead(open, active);
+    }
+    return 0;
+}
+
+int run_open_system(const char* input_path, const _scheduling_algorithm* algorithm, uint32_t quantum,
+                    uint32_t window, uint32_t report_flags)
+{
+    _open_system* open = calloc(1, sizeof(_open_system));
+    _random_source randomSource;
+    if (!open){
+        printf("Out of memory starting an open-system run\n");
+        return -1;
+    }
+    if (random_source_load(&randomSource, RANDOM_NUMBER_FILE_NAME) != 0){
+        printf("%s not found\n", RANDOM_NUMBER_FILE_NAME);
+        free(open);
+        return -1;
+    }
+
+    int status = workload_reader_open_stream(&(*open).reader, input_path);
+    if (status == -1){
+        printf("%s not found\n", input_path);
+    }
+    else if (status == -3){
+        printf("%s: line %u: %s\n", input_path, (*open).reader.line, (*open).reader.error);
+    }
+    else if (status != 0){
+        printf("Out of memory reading %s\n", input_path);
+    }
+
+    _simulation* sim = &(*open).sim;
+    _histogram* histograms = calloc(2, sizeof(_histogram));
+    (*sim).randomSource = &randomSource;
+    (*sim).quantum = quantum;
+    (*sim).turnaroundHistogram = histograms;
+    (*sim).waitingHistogram = histograms ? histograms + 1 : NULL;
+    (*open).policy = (*algorithm).policy;
+    (*open).window = window;
+    (*open).randomPeriod = randomSource.count > SEED_VALUE ? randomSource.count - SEED_VALUE + 1 : 0;
+    if (status == 0 && (!histograms || policy_queue_init(&(*open).ready, (*open).policy, 0) != 0
+                        || blocked_set_init(&(*open).blocked, 0) != 0 || grow_slots(open) != 0)){
+        printf("Out of memory starting an open-system run\n");
+        status = -1;
+    }
+
+    if (status == 0){
+        histogram_init((*sim).turnaroundHistogram);
+        histogram_init((*sim).waitingHistogram);
+        histogram_init(&(*open).current.turnaroundHistogram);
+        printf("Open system: %s under %s", input_path, (*algorithm).name);
+        if ((*algorithm).usesQuantum){
+            printf(" (quantum %u)", quantum);
+        }
+        printf(", a row every %u cycles\n", window);
+        printf("cycle,arrived,finished,live,ready,blocked,cpu_utilisation,io_utilisation,throughput,"
+               "average_turnaround,average_waiting,p50_turnaround,p95_turnaround,p99_turnaround\n");
+        fflush(stdout);
+        status = read_ahead(open, input_path);
+    }
+    if (status == 0){
+        status = run_stream(open, input_path);
+    }
+
+    if (status == 0 && (*sim).totalFinishedProcesses){
+        _summary_data summary;
+        _report_writer out;
+        uint32_t final_finishing_time = (*sim).currentCycle - 1;
+
+        (*sim).currentCycle = final_finishing_time;
+        if (final_finishing_time % window){
+            close_window(open);
+        }
+        summary.finishingTime = final_finishing_time;
+        summary.cpuUtilisation = (double) (*open).busyCycles / final_finishing_time;
+        summary.ioUtilisation = (double) (*sim).totalCyclesSpentBlocked / final_finishing_time;
+        summary.throughput = 100 * ((double) (*sim).totalFinishedProcesses / final_finishing_time);
+        summary.averageTurnaroundTime = (double) (*open).turnaround / (*sim).totalFinishedProcesses;
+        summary.averageWaitingTime = (double) (*open).waiting / (*sim).totalFinishedProcesses;
+
+        fflush(stdout);
+        if (report_writer_init(&out, stdout) == 0){
+            report_char(&out, '\n');
+            printSummary(&summary, &out);
+            if (report_flags & REPORT_LATENCY){
+                printLatencyData(sim, &out);
+            }
+            report_text(&out, "\nOpen System Data:\n\tProcesses: ");
+            report_uint(&out, (*open).arrived);
+            report_text(&out, "\n\tPeak live processes: ");
+            report_uint(&out, (*open).peakLive);
+            report_text(&out, "\n\tProcess slots: ");
+            report_uint(&out, (*open).capacity);
+            report_char(&out, '\n');
+        }
+        if (report_writer_close(&out) != 0){
+            status = -1;
+        }
+    }
+
+    workload_reader_close(&(*open).reader);
+    policy_queue_free(&(*open).ready);
+    blocked_set_free(&(*open).blocked);
+    free(histograms);
+    free((*open).specs);
+    free((*sim).states);
+    free((*sim).stats);
+    free((*open).randomIndex);
+    free((*open).freeSlots);
+    random_source_free(&randomSource);
+    free(open);
+    return status;
+}
@@ -0,0 +1,31 @@
+#ifndef OPEN_SYSTEM_H
+#define OPEN_SYSTEM_H
+
+#include <stdint.h>
+
+#include "scheduler.h"
+
+#define OPEN_DEFAULT_WINDOW 1000        // Cycles per rolling window unless --window says otherwise
+#define OPEN_INITIAL_SLOTS 1024         // Process slots allocated before the first one is needed
+
+/*
+ * The open-system engine. Processes come from an arrival stream ("(A B C M) ..." in non-decreasing
+ * arrival order, with or without a leading count) that is read one process ahead of the simulation, so
+ * the stream can be endless. A process only holds a slot while it is live: its slot goes back to a free
+ * list when it finishes and the next arrival reuses it, so memory follows the peak number of live processes
+ * rather than the length of the stream. The n-th process of the stream (from 0) draws its bursts from random
+ * number SEED_VALUE + n, wrapping round at the end of the random table, so a stream that fits the table runs
+ * exactly as the closed engines run it (PRIORITY aside, which breaks ties on the slot rather than the position). Every window cycles the engine prints a row of rolling metrics, and once the stream
+ * ends and the last process finishes, the run's Summary Data.
+ */
+
+/**
+ * Runs algorithm with quantum over the stream in input_path (WORKLOAD_READER_STDIN for standard input),
+ * printing a metrics row every window cycles to stdout and the summary at the end (with the latency block when
+ * report_flags has REPORT_LATENCY). Returns 0 on success, -1 if the stream or the random numbers can't be read,
+ * the stream is malformed or memory runs out.
+ */
+int run_open_system(const char* input_path, const _scheduling_algorithm* algorithm, uint32_t quantum,
+                    uint32_t window, uint32_t report_flags);
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef POLICIES_H
+#define POLICIES_H
+
+#include "policy.h"
+
+/*
+ * The hooks of the built-in policies. They are inline, and every policy's hooks are also named by an
+ * initializer, so a file that runs a policy through a constant copy of it can have its engine compiled
+ * once per policy with the hooks called directly (see scheduler.c). The extern policies in policy.c
+ * are built from the same initializers.
+ */
+
+/**
+ * The cycle a time slice running out would make the next decision on, if it hasn't already run out
+ */
+static inline uint32_t quantum_decision(const _simulation* sim, const _policy_queue* queue, uint32_t active)
+{
+    (void) queue;
+    int32_t quantum = (*sim).states[active].quantum;
+    return quantum > 0 ? (*sim).currentCycle - 1 + (uint32_t) quantum : UINT32_MAX;
+}
+
+// First come first serve and round robin ----------
+
+static inline void fifo_ready(_simulation* sim, _policy_queue* queue, uint32_t process)
+{
+    (void) sim;
+    ready_queue_push(&(*queue).fifo[0], process);
+}
+
+static inline uint32_t fifo_pick(_simulation* sim, _policy_queue* queue)
+{
+    (void) sim;
+    return ready_queue_pop(&(*queue).fifo[0]);
+}
+
+static inline uint32_t rr_pick(_simulation* sim, _policy_queue* queue)
+{
+    uint32_t process = ready_queue_pop(&(*queue).fifo[0]);
+    (*sim).states[process].quantum = (*sim).quantum;
+    return process;
+}
+
+/**
+ * A slice that runs out with nobody waiting keeps running, past zero, until the process blocks
+ */
+static inline bool rr_preempt(_simulation* sim, _policy_queue* queue, uint32_t active)
+{
+    return (*sim).states[active].quantum == 0 && (*queue).length;
+}
+
+// Shortest job first and shortest remaining time first ----------
+
+/**
+ * Queues process keyed on its remaining CPU time, then arrival time, then process ID
+ */
+static inline void shortest_ready(_simulation* sim, _policy_queue* queue, uint32_t process)
+{
+    const _process_spec* spec = &(*sim).specs[process];
+    ready_heap_push(&(*queue).heap, (*spec).C - (*sim).states[process].currentCPUTimeRun, (*spec).A, process);
+}
+
+static inline uint32_t heap_pick(_simulation* sim, _policy_queue* queue)
+{
+    (void) sim;
+    return ready_heap_pop(&(*queue).heap);
+}
+
+static inline bool srtf_preempt(_simulation* sim, _policy_queue* queue, uint32_t active)
+{
+    return (*queue).heap.length && (*queue).heap.entries[0].remaining
+                                       < (*sim).specs[active].C - (*sim).states[active].currentCPUTimeRun;
+}
+
+// Multi-level feedback queue ----------
+
+/**
+ * A process that uses up its slice drops a level; one that blocks first keeps its level
+ */
+static inline void mlfq_ready(_simulation* sim, _policy_queue* queue, uint32_t process)
+{
+    ready_queue_push(&(*queue).fifo[(*sim).states[process].level], process);
+}
+
+static inline uint32_t mlfq_pick(_simulation* sim, _policy_queue* queue)
+{
+    uint32_t level = 0;
+    while (!(*queue).fifo[level].length){
+        level++;
+    }
+    uint32_t process = ready_queue_pop(&(*queue).fifo[level]);
+    (*sim).states[process].quantum = (int32_t) ((*sim).quantum << level);
+    return process;
+}
+
+static inline bool mlfq_preempt(_simulation* sim, _policy_queue* queue, uint32_t active)
+{
+    _process_state* state = &(*sim).states[active];
+    if ((*state).quantum == 0){
+        if ((*state).level + 1 < MLFQ_LEVELS){
+            (*state).level++;
+        }
+        if ((*queue).length){
+            return true;
+        }
+        (*state).quantum = (int32_t) ((*sim).quantum << (*state).level);
+        return false;
+    }
+    for (uint32_t level = 0; level < (*state).level; level++){
+        if ((*queue).fifo[level].length){
+            return true;
+        }
+    }
+    return false;
+}
+
+// Priority with aging ----------
+
+/*
+ * A process's base priority is its burst bound B, so processes with short bursts run first, and every
+ * PRIORITY_AGING_CYCLES it waits lift it one level. Waiting processes age at the same rate, so their order
+ * never changes while they wait and the heap keys them on B * PRIORITY_AGING_CYCLES + readySinceCycle.
+ * The running process keeps the priority it had aged to, so only a newly ready process can beat it.
+ */
+
+static inline uint64_t priority_key(const _simulation* sim, uint32_t process)
+{
+    return (uint64_t) (*sim).specs[process].B * PRIORITY_AGING_CYCLES + (*sim).states[process].readySinceCycle;
+}
+
+static inline void priority_ready(_simulation* sim, _policy_queue* queue, uint32_t process)
+{
+    uint64_t key = priority_key(sim, process);
+    ready_heap_push(&(*queue).heap, (uint32_t) (key >> 32), (uint32_t) key, process);
+}
+
+static inline bool priority_preempt(_simulation* sim, _policy_queue* queue, uint32_t active)
+{
+    if (!(*queue).heap.length){
+        return false;
+    }
+    uint64_t best = (uint64_t) (*queue).heap.entries[0].remaining << 32 | (*queue).heap.entries[0].A;
+    return best < priority_key(sim, active);
+}
+
+#define FCFS_POLICY_HOOKS { 1, false, false, fifo_ready, fifo_pick, NULL, NULL }
+#define RR_POLICY_HOOKS { 1, false, true, fifo_ready, rr_pick, rr_preempt, quantum_decision }
+#define SJF_POLICY_HOOKS { 0, true, false, shortest_ready, heap_pick, NULL, NULL }
+#define SRTF_POLICY_HOOKS { 0, true, false, shortest_ready, heap_pick, srtf_preempt, NULL }
+#define MLFQ_POLICY_HOOKS { MLFQ_LEVELS, false, true, mlfq_ready, mlfq_pick, mlfq_preempt, quantum_decision }
+#define PRIORITY_POLICY_HOOKS { 0, true, false, priority_ready, heap_pick, priority_preempt, NULL }
+
+#endif
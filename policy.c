@@ -0,0 +1,49 @@
+#include "policy.h"
+#include "policies.h"
+
+#include <string.h>
+
+int policy_queue_init(_policy_queue* queue, const _scheduling_policy* policy, uint32_t capacity)
+{
+    memset(queue, 0, sizeof(*queue));
+    for (uint32_t level = 0; level < (*policy).fifoLevels; level++){
+        if (ready_queue_init(&(*queue).fifo[level], capacity) != 0){
+            policy_queue_free(queue);
+            return -1;
+        }
+    }
+    if ((*policy).usesHeap && ready_heap_init(&(*queue).heap, capacity) != 0){
+        policy_queue_free(queue);
+        return -1;
+    }
+    return 0;
+}
+
+void policy_queue_free(_policy_queue* queue)
+{
+    for (uint32_t level = 0; level < POLICY_MAX_LEVELS; level++){
+        ready_queue_free(&(*queue).fifo[level]);
+    }
+    ready_heap_free(&(*queue).heap);
+    (*queue).length = 0;
+}
+
+int policy_queue_grow(_policy_queue* queue, const _scheduling_policy* policy, uint32_t capacity)
+{
+    for (uint32_t level = 0; level < (*policy).fifoLevels; level++){
+        if (ready_queue_grow(&(*queue).fifo[level], capacity) != 0){
+            return -1;
+        }
+    }
+    if ((*policy).usesHeap && ready_heap_grow(&(*queue).heap, capacity) != 0){
+        return -1;
+    }
+    return 0;
+}
+
+const _scheduling_policy FCFS_POLICY = FCFS_POLICY_HOOKS;
+const _scheduling_policy RR_POLICY = RR_POLICY_HOOKS;
+const _scheduling_policy SJF_POLICY = SJF_POLICY_HOOKS;
+const _scheduling_policy SRTF_POLICY = SRTF_POLICY_HOOKS;
+const _scheduling_policy MLFQ_POLICY = MLFQ_POLICY_HOOKS;
+const _scheduling_policy PRIORITY_POLICY = PRIORITY_POLICY_HOOKS;
@@ -0,0 +1,82 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "scheduler.h"
+
+#define POLICY_MAX_LEVELS 3             // Ready FIFOs a policy can keep (MLFQ keeps one per level)
+#define MLFQ_LEVELS POLICY_MAX_LEVELS   // MLFQ levels; level k runs with a slice of quantum << k
+#define PRIORITY_AGING_CYCLES 10        // Cycles of waiting that lift a process one priority level
+
+/*
+ * A policy decides which ready process runs next and whether the running one should give way;
+ * the engines (simulate and smp.c) do everything else. Processes reach the policy through
+ * make_ready, with their status and readySinceCycle already set, and leave it through pick_next.
+ */
+
+/* The ready processes of a run (or of one CPU), kept in whichever structure the policy uses */
+typedef struct PolicyQueue {
+    _ready_queue fifo[POLICY_MAX_LEVELS]; // FIFO policies use level 0, MLFQ one per level
+    _ready_heap heap;                   // Heap policies, on a key of their own
+    uint32_t length;                    // Ready processes across every structure
+} _policy_queue;
+
+struct SchedulingPolicy {
+    uint32_t fifoLevels;                // The FIFOs the policy uses
+    bool usesHeap;                      // Whether the policy uses the heap
+    bool timeSliced;                    // Whether running processes use up a quantum
+
+    /** Queues process, whose status and readySinceCycle are already set */
+    void (*ready)(_simulation* sim, _policy_queue* queue, uint32_t process);
+    /** Removes and returns the process to run next; the queue is not empty */
+    uint32_t (*pick)(_simulation* sim, _policy_queue* queue);
+    /** After active has run a cycle without finishing or blocking: true sends it back to ready (NULL never preempts) */
+    bool (*preempt)(_simulation* sim, _policy_queue* queue, uint32_t active);
+    /**
+     * Called once (*sim).currentCycle has moved past the cycle just simulated: the cycle on which preempt
+     * could next answer differently without an arrival or an I/O completion, or UINT32_MAX (NULL: never)
+     */
+    uint32_t (*nextDecision)(const _simulation* sim, const _policy_queue* queue, uint32_t active);
+};
+
+extern const _scheduling_policy FCFS_POLICY;     // First come first serve
+extern const _scheduling_policy RR_POLICY;       // Round robin on (*sim).quantum
+extern const _scheduling_policy SJF_POLICY;      // Least remaining CPU time first, never preempts
+extern const _scheduling_policy SRTF_POLICY;     // SJF that preempts for a strictly shorter process
+extern const _scheduling_policy MLFQ_POLICY;     // Multi-level feedback queue
+extern const _scheduling_policy PRIORITY_POLICY; // Preemptive priority (B, lower first) with aging
+
+/**
+ * Allocates room for capacity processes in the structures policy uses.
+ * Returns 0 on success, -1 if the allocation fails.
+ */
+int policy_queue_init(_policy_queue* queue, const _scheduling_policy* policy, uint32_t capacity);
+void policy_queue_free(_policy_queue* queue);
+
+/**
+ * Makes room for capacity processes in the structures policy uses, keeping the queued ones.
+ * Returns 0 on success, -1 if the allocation fails.
+ */
+int policy_queue_grow(_policy_queue* queue, const _scheduling_policy* policy, uint32_t capacity);
+
+/**
+ * Moves process to ready under policy
+ */
+void make_ready(_simulation* sim, const _scheduling_policy* policy, _policy_queue* queue, uint32_t process);
+
+/**
+ * Takes the process policy runs next off a non-empty queue
+ */
+static inline uint32_t pick_next(_simulation* sim, const _scheduling_policy* policy, _policy_queue* queue)
+{
+    (*queue).length--;
+    return (*policy).pick(sim, queue);
+}
+
+/**
+ * Runs sim to completion on one CPU under policy, calling its hooks through their pointers.
+ * The built-in algorithms (FCFS through PRIORITY) run the same engine specialised to their policy.
+ * Returns 0 once the run is complete, -1 if its queues can't be allocated or its checkpoint can't be resumed.
+ */
+int simulate(_simulation* sim, const _scheduling_policy* policy);
+
+#endif
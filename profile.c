@@ -0,0 +1,39 @@
+#include "profile.h"
+
+#include <time.h>
+
+double profile_now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+static void print_count(_report_writer* out, const char* label, uint64_t count)
+{
+    report_char(out, '\t');
+    report_text(out, label);
+    report_text(out, ": ");
+    report_uint(out, count);
+    report_char(out, '\n');
+}
+
+void printProfile(const _profile* profile, uint64_t events, _report_writer* out)
+{
+    report_text(out, "\nProfile:\n\tSimulate time: ");
+    report_fixed6(out, (*profile).phaseSeconds[PROFILE_SIMULATE]);
+    report_text(out, " seconds\n\tReport time: ");
+    report_fixed6(out, (*profile).phaseSeconds[PROFILE_REPORT]);
+    report_text(out, " seconds\n");
+    print_count(out, "Cycles stepped through", events);
+    print_count(out, "Cycles skipped", (*profile).skippedCycles);
+    print_count(out, "Skips", (*profile).skips);
+    print_count(out, "Arrival checks", (*profile).arrivalChecks);
+    print_count(out, "Unblock checks", (*profile).unblockChecks);
+    print_count(out, "Ready insertions", (*profile).readyInserts);
+    print_count(out, "Blocked insertions", (*profile).blockedInserts);
+    print_count(out, "Sorted list steps", (*profile).listSteps);
+    print_count(out, "Random number lookups", (*profile).randomLookups);
+    print_count(out, "Dispatches", (*profile).dispatches);
+    print_count(out, "Preemptions", (*profile).preemptions);
+}
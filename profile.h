@@ -0,0 +1,51 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+#include "report_writer.h"
+
+/*
+ * Opt-in instrumentation of the scheduling loop. Built with -DSCHEDULER_PROFILE (make profile), every run
+ * counts the work its engine does and times its phases, and each report ends with a profile block.
+ * Otherwise the PROFILE_* macros expand to nothing and the counters don't exist.
+ */
+
+typedef enum { PROFILE_SIMULATE, PROFILE_REPORT, PROFILE_PHASE_COUNT } _profile_phase;
+
+/* The work one run did, by kind */
+typedef struct Profile {
+    uint64_t arrivalChecks;             // Looks for an arriving process (reference: processes scanned)
+    uint64_t unblockChecks;             // Looks for a process finishing I/O (reference: blocked entries ticked)
+    uint64_t readyInserts;              // Processes put on the ready queue
+    uint64_t blockedInserts;            // Processes put in the blocked set
+    uint64_t listSteps;                 // Entries moved to keep the reference engine's lists sorted
+    uint64_t randomLookups;             // Bursts drawn through randomOS
+    uint64_t dispatches;                // Processes moved to running
+    uint64_t preemptions;               // Processes sent back to ready by the quantum
+    uint64_t skips;                     // Jumps made by skip_to_next_event
+    uint64_t skippedCycles;             // Cycles those jumps covered
+    double phaseSeconds[PROFILE_PHASE_COUNT]; // Wall-clock time of each phase
+} _profile;
+
+/**
+ * Returns the monotonic clock in seconds
+ */
+double profile_now(void);
+
+/**
+ * Writes the profile block of a run that stepped through events cycles
+ */
+void printProfile(const _profile* profile, uint64_t events, _report_writer* out);
+
+#ifdef SCHEDULER_PROFILE
+#define PROFILE_COUNT(sim, counter, amount) ((*(sim)).profile.counter += (amount))
+#define PROFILE_START(start) double start = profile_now()
+#define PROFILE_STOP(profile, phase, start) ((profile).phaseSeconds[phase] += profile_now() - (start))
+#else
+#define PROFILE_COUNT(sim, counter, amount) ((void) 0)
+#define PROFILE_START(start) ((void) 0)
+#define PROFILE_STOP(profile, phase, start) ((void) 0)
+#endif
+
+#endif
@@ -0,0 +1,200 @@
+#include "random_source.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define RANDOM_LINE_LENGTH 512                      // getRandNumFromFile's fgets buffer size
+#define RANDOM_CACHE_MAGIC "RNDT"
+#define RANDOM_CACHE_VERSION 1
+
+/* Header of the binary sidecar, followed by count uint32_t values */
+typedef struct RandomCacheHeader {
+    char magic[4];                      // Always RANDOM_CACHE_MAGIC
+    uint32_t version;                   // Bumped whenever the layout changes
+    uint32_t count;                     // The number of values following the header
+    uint32_t reserved;                  // Keeps the values 8-byte aligned
+    uint64_t sourceSize;                // Size of the text file the cache was built from
+    int64_t sourceModified;             // Modification time of the text file the cache was built from
+} _random_cache_header;
+
+/**
+ * Parses one line the way atoi did for the old fgets loop
+ */
+static uint32_t parse_line(const char* line, size_t length)
+{
+    size_t i = 0;
+    int negative = 0;
+    int64_t value = 0;
+
+    while (i < length && (line[i] == ' ' || (line[i] >= '\t' && line[i] <= '\r'))){
+        i++;
+    }
+    if (i < length && (line[i] == '-' || line[i] == '+')){
+        negative = line[i] == '-';
+        i++;
+    }
+    while (i < length && line[i] >= '0' && line[i] <= '9'){
+        value = value * 10 + (line[i] - '0');
+        i++;
+    }
+    return (uint32_t) (int32_t) (negative ? -value : value);
+}
+
+/**
+ * Splits text into lines exactly as repeated fgets calls with a RANDOM_LINE_LENGTH buffer would.
+ * Fills numbers (when not NULL) and returns the number of lines.
+ */
+static uint32_t parse_text(const char* text, size_t length, uint32_t* numbers)
+{
+    uint32_t count = 0;
+    size_t start = 0;
+
+    while (start < length){
+        size_t end = start;
+        while (end < length && end - start < RANDOM_LINE_LENGTH - 1){
+            if (text[end++] == '\n'){
+                break;
+            }
+        }
+        if (numbers){
+            numbers[count] = parse_line(text + start, end - start);
+        }
+        count++;
+        start = end;
+    }
+    return count;
+}
+
+/**
+ * Maps the sidecar if it exists and was built from a file matching source_stat
+ */
+static int map_cache(_random_source* source, const char* cache_name, const struct stat* source_stat)
+{
+    int fd = open(cache_name, O_RDONLY);
+    if (fd < 0){
+        return -1;
+    }
+    struct stat cache_stat;
+    if (fstat(fd, &cache_stat) != 0 || (size_t) cache_stat.st_size < sizeof(_random_cache_header)){
+        close(fd);
+        return -1;
+    }
+    void* mapping = mmap(NULL, cache_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED){
+        return -1;
+    }
+
+    const _random_cache_header* header = mapping;
+    if (memcmp((*header).magic, RANDOM_CACHE_MAGIC, 4) != 0 || (*header).version != RANDOM_CACHE_VERSION
+            || (*header).sourceSize != (uint64_t) (*source_stat).st_size
+            || (*header).sourceModified != (int64_t) (*source_stat).st_mtime
+            || (size_t) cache_stat.st_size != sizeof(_random_cache_header) + (size_t) (*header).count * sizeof(uint32_t)){
+        munmap(mapping, cache_stat.st_size);
+        return -1;
+    }
+
+    (*source).numbers = (const uint32_t*) (header + 1);
+    (*source).count = (*header).count;
+    (*source).mapping = mapping;
+    (*source).mappingLength = cache_stat.st_size;
+    return 0;
+}
+
+/**
+ * Best-effort write of the sidecar; a read-only directory just means the next run parses again
+ */
+static void write_cache(const _random_source* source, const char* cache_name, const struct stat* source_stat)
+{
+    char temp_name[4096];
+    if (snprintf(temp_name, sizeof(temp_name), "%s.%ld", cache_name, (long) getpid()) >= (int) sizeof(temp_name)){
+        return;
+    }
+    FILE* fp = fopen(temp_name, "wb");
+    if (fp == NULL){
+        return;
+    }
+
+    _random_cache_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RANDOM_CACHE_MAGIC, 4);
+    header.version = RANDOM_CACHE_VERSION;
+    header.count = (*source).count;
+    header.sourceSize = (uint64_t) (*source_stat).st_size;
+    header.sourceModified = (int64_t) (*source_stat).st_mtime;
+
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1
+             && fwrite((*source).numbers, sizeof(uint32_t), (*source).count, fp) == (*source).count;
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || rename(temp_name, cache_name) != 0){
+        unlink(temp_name);
+    }
+}
+
+int random_source_load(_random_source* source, const char* file_name)
+{
+    memset(source, 0, sizeof(*source));
+
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0){
+        return -1;
+    }
+    struct stat source_stat;
+    if (fstat(fd, &source_stat) != 0){
+        close(fd);
+        return -1;
+    }
+
+    char cache_name[4096];
+    int use_cache = snprintf(cache_name, sizeof(cache_name), "%s%s", file_name, RANDOM_NUMBER_CACHE_SUFFIX)
+                    < (int) sizeof(cache_name);
+    if (use_cache && map_cache(source, cache_name, &source_stat) == 0){
+        close(fd);
+        return 0;
+    }
+
+    size_t length = source_stat.st_size;
+    const char* text = NULL;
+    if (length > 0){
+        text = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (text == MAP_FAILED){
+            close(fd);
+            return -1;
+        }
+    }
+    close(fd);
+
+    uint32_t count = parse_text(text, length, NULL);
+    uint32_t* numbers = malloc((count ? count : 1) * sizeof(uint32_t));
+    if (numbers == NULL){
+        if (text){
+            munmap((void*) text, length);
+        }
+        return -1;
+    }
+    parse_text(text, length, numbers);
+    if (text){
+        munmap((void*) text, length);
+    }
+
+    (*source).numbers = (*source).owned = numbers;
+    (*source).count = count;
+    if (use_cache){
+        write_cache(source, cache_name, &source_stat);
+    }
+    return 0;
+}
+
+void random_source_free(_random_source* source)
+{
+    if ((*source).mapping){
+        munmap((*source).mapping, (*source).mappingLength);
+    }
+    free((*source).owned);
+    memset(source, 0, sizeof(*source));
+}
@@ -0,0 +1,42 @@
+#ifndef RANDOM_SOURCE_H
+#define RANDOM_SOURCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RANDOM_NUMBER_FAIL_SAFE 1804289383u        // Returned for lines past the end of the file
+#define RANDOM_NUMBER_CACHE_SUFFIX ".bin"           // Sidecar cache name is the source name plus this suffix
+
+/* The random-numbers file, loaded once into a compact table */
+typedef struct RandomSource {
+    const uint32_t* numbers;            // numbers[i] is the value on line i + 1 of the source file
+    uint32_t count;                     // The number of lines in the source file
+
+    void* mapping;                      // The mmap'd sidecar cache (NULL when the table was parsed)
+    size_t mappingLength;               // The length of the mapping in bytes
+    uint32_t* owned;                    // The parsed table (NULL when the sidecar was mapped)
+} _random_source;
+
+/**
+ * Loads file_name into source, preferring an up to date binary sidecar (file_name + ".bin")
+ * and writing one when it is missing or stale. Returns 0 on success, -1 if file_name can't be read.
+ */
+int random_source_load(_random_source* source, const char* file_name);
+
+/**
+ * Releases the table held by source
+ */
+void random_source_free(_random_source* source);
+
+/**
+ * Returns the number on the given (1-based) line, as getRandNumFromFile used to by rescanning the file
+ */
+static inline uint32_t random_source_line(const _random_source* source, uint32_t line)
+{
+    if (line == 0 || line > (*source).count){
+        return RANDOM_NUMBER_FAIL_SAFE;
+    }
+    return (*source).numbers[line - 1];
+}
+
+#endif
@@ -0,0 +1,125 @@
+#include "ready_queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int ready_queue_init(_ready_queue* queue, uint32_t capacity)
+{
+    (*queue).slots = malloc((capacity ? capacity : 1) * sizeof(uint32_t));
+    (*queue).capacity = capacity ? capacity : 1;
+    (*queue).head = (*queue).length = 0;
+    return (*queue).slots ? 0 : -1;
+}
+
+void ready_queue_free(_ready_queue* queue)
+{
+    free((*queue).slots);
+    (*queue).slots = NULL;
+    (*queue).capacity = (*queue).head = (*queue).length = 0;
+}
+
+int ready_queue_grow(_ready_queue* queue, uint32_t capacity)
+{
+    if (capacity <= (*queue).capacity){
+        return 0;
+    }
+    uint32_t* slots = malloc((size_t) capacity * sizeof(uint32_t));
+    if (!slots){
+        return -1;
+    }
+    // The queue comes across front first, so it no longer wraps whatever the new capacity
+    uint32_t first = (*queue).capacity - (*queue).head;
+    first = first < (*queue).length ? first : (*queue).length;
+    memcpy(slots, (*queue).slots + (*queue).head, (size_t) first * sizeof(uint32_t));
+    memcpy(slots + first, (*queue).slots, (size_t) ((*queue).length - first) * sizeof(uint32_t));
+    free((*queue).slots);
+    (*queue).slots = slots;
+    (*queue).capacity = capacity;
+    (*queue).head = 0;
+    return 0;
+}
+
+int ready_heap_init(_ready_heap* heap, uint32_t capacity)
+{
+    (*heap).entries = malloc((capacity ? capacity : 1) * sizeof(_ready_heap_entry));
+    (*heap).capacity = capacity ? capacity : 1;
+    (*heap).length = 0;
+    return (*heap).entries ? 0 : -1;
+}
+
+int ready_heap_grow(_ready_heap* heap, uint32_t capacity)
+{
+    if (capacity <= (*heap).capacity){
+        return 0;
+    }
+    _ready_heap_entry* entries = realloc((*heap).entries, (size_t) capacity * sizeof(_ready_heap_entry));
+    if (!entries){
+        return -1;
+    }
+    (*heap).entries = entries;
+    (*heap).capacity = capacity;
+    return 0;
+}
+
+void ready_heap_free(_ready_heap* heap)
+{
+    free((*heap).entries);
+    (*heap).entries = NULL;
+    (*heap).capacity = (*heap).length = 0;
+}
+
+/**
+ * True when a should run before b
+ */
+static inline int entry_before(const _ready_heap_entry* a, const _ready_heap_entry* b)
+{
+    if ((*a).remaining != (*b).remaining){
+        return (*a).remaining < (*b).remaining;
+    }
+    if ((*a).A != (*b).A){
+        return (*a).A < (*b).A;
+    }
+    return (*a).processID < (*b).processID;
+}
+
+void ready_heap_push(_ready_heap* heap, uint32_t remaining, uint32_t A, uint32_t process_indx)
+{
+    _ready_heap_entry entry = { remaining, A, process_indx };
+    uint32_t i = (*heap).length++;
+
+    while (i > 0){
+        uint32_t parent = (i - 1) / 2;
+        if (!entry_before(&entry, &(*heap).entries[parent])){
+            break;
+        }
+        (*heap).entries[i] = (*heap).entries[parent];
+        i = parent;
+    }
+    (*heap).entries[i] = entry;
+}
+
+uint32_t ready_heap_pop(_ready_heap* heap)
+{
+    uint32_t process_indx = (*heap).entries[0].processID;
+    _ready_heap_entry last = (*heap).entries[--(*heap).length];
+    uint32_t i = 0;
+
+    while (1){
+        uint32_t child = 2 * i + 1;
+        if (child >= (*heap).length){
+            break;
+        }
+        if (child + 1 < (*heap).length && entry_before(&(*heap).entries[child + 1], &(*heap).entries[child])){
+            child++;
+        }
+        if (!entry_before(&(*heap).entries[child], &last)){
+            break;
+        }
+        (*heap).entries[i] = (*heap).entries[child];
+        i = child;
+    }
+    if ((*heap).length > 0){
+        (*heap).entries[i] = last;
+    }
+    return process_indx;
+}
@@ -0,0 +1,84 @@
+#ifndef READY_QUEUE_H
+#define READY_QUEUE_H
+
+#include <stdint.h>
+
+/* FIFO of process indices for FCFS and RR, a ring buffer so push and pop are O(1) */
+typedef struct ReadyQueue {
+    uint32_t* slots;                    // The queued process indices, starting at head and wrapping around
+    uint32_t capacity;                  // The number of slots (every process can be queued at once)
+    uint32_t head;                      // The slot holding the front of the queue
+    uint32_t length;                    // The number of queued processes
+} _ready_queue;
+
+/* A process waiting in the SJF heap, with the key it was queued under */
+typedef struct ReadyHeapEntry {
+    uint32_t remaining;                 // C - currentCPUTimeRun when the process became ready
+    uint32_t A;                         // Arrival time, the first tie-breaker
+    uint32_t processID;                 // Process ID, the second tie-breaker (and the process index)
+} _ready_heap_entry;
+
+/* Binary min-heap ordered on (remaining, A, processID) for SJF */
+typedef struct ReadyHeap {
+    _ready_heap_entry* entries;         // entries[0] is the next process to run
+    uint32_t capacity;                  // The number of entries allocated
+    uint32_t length;                    // The number of queued processes
+} _ready_heap;
+
+/**
+ * Allocates room for capacity processes. Returns 0 on success, -1 if the allocation fails.
+ */
+int ready_queue_init(_ready_queue* queue, uint32_t capacity);
+void ready_queue_free(_ready_queue* queue);
+int ready_heap_init(_ready_heap* heap, uint32_t capacity);
+void ready_heap_free(_ready_heap* heap);
+
+/**
+ * Makes room for capacity processes, keeping what is queued in order (any capacity above the current one will do).
+ * Returns 0 on success, -1 if the allocation fails (the queue is left as it was).
+ */
+int ready_queue_grow(_ready_queue* queue, uint32_t capacity);
+int ready_heap_grow(_ready_heap* heap, uint32_t capacity);
+
+/**
+ * Queues process_indx on the ready heap under the key (remaining, A, process_indx)
+ */
+void ready_heap_push(_ready_heap* heap, uint32_t remaining, uint32_t A, uint32_t process_indx);
+
+/**
+ * Removes and returns the index of the process with the smallest key. The heap must not be empty.
+ */
+uint32_t ready_heap_pop(_ready_heap* heap);
+
+static inline void ready_queue_push(_ready_queue* queue, uint32_t process_indx)
+{
+    uint32_t slot = (*queue).head + (*queue).length++;
+    if (slot >= (*queue).capacity){
+        slot -= (*queue).capacity;
+    }
+    (*queue).slots[slot] = process_indx;
+}
+
+/**
+ * Removes and returns the process index at the front of the queue. The queue must not be empty.
+ */
+static inline uint32_t ready_queue_pop(_ready_queue* queue)
+{
+    uint32_t process_indx = (*queue).slots[(*queue).head];
+    if (++(*queue).head == (*queue).capacity){
+        (*queue).head = 0;
+    }
+    (*queue).length--;
+    return process_indx;
+}
+
+/**
+ * Returns the i-th queued process index, counting from the front
+ */
+static inline uint32_t ready_queue_at(const _ready_queue* queue, uint32_t i)
+{
+    uint32_t slot = (*queue).head + i;
+    return (*queue).slots[slot >= (*queue).capacity ? slot - (*queue).capacity : slot];
+}
+
+#endif
@@ -0,0 +1,266 @@
+#include "reference.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "policy.h"
+
+typedef enum { REFERENCE_FCFS, REFERENCE_RR, REFERENCE_SJF, REFERENCE_SRTF, REFERENCE_MLFQ, REFERENCE_PRIORITY } _reference_policy;
+
+/* The queues of a reference run */
+typedef struct ReferenceQueues {
+    uint32_t* ready;                    // Ready processes, front first (sorted, other than for FCFS and RR)
+    uint32_t readyLength;               // The number of ready processes
+    uint32_t* blocked;                  // Blocked processes, sorted on the I/O they have left
+    uint32_t blockedLength;             // The number of blocked processes
+    uint32_t* ioLeft;                   // The cycles of I/O each blocked process has left, by process ID
+} _reference_queues;
+
+/**
+ * True when SJF should run process a before process b: less CPU time left, then earlier arrival, then lower ID
+ */
+static int sjf_before(const _simulation* sim, uint32_t a, uint32_t b)
+{
+    uint32_t left_a = (*sim).specs[a].C - (*sim).states[a].currentCPUTimeRun;
+    uint32_t left_b = (*sim).specs[b].C - (*sim).states[b].currentCPUTimeRun;
+    if (left_a != left_b){
+        return left_a < left_b;
+    }
+    if ((*sim).specs[a].A != (*sim).specs[b].A){
+        return (*sim).specs[a].A < (*sim).specs[b].A;
+    }
+    return a < b;
+}
+
+static uint32_t remaining(const _simulation* sim, uint32_t process)
+{
+    return (*sim).specs[process].C - (*sim).states[process].currentCPUTimeRun;
+}
+
+/**
+ * The aged priority of process for priority with aging, lower first (see policy.c)
+ */
+static uint64_t priority_key(const _simulation* sim, uint32_t process)
+{
+    return (uint64_t) (*sim).specs[process].B * PRIORITY_AGING_CYCLES + (*sim).states[process].readySinceCycle;
+}
+
+/**
+ * True when process a should queue ahead of process b
+ */
+static int runs_before(const _simulation* sim, _reference_policy policy, uint32_t a, uint32_t b)
+{
+    switch (policy){
+        case REFERENCE_SJF:
+        case REFERENCE_SRTF:
+            return sjf_before(sim, a, b);
+        case REFERENCE_MLFQ:
+            return (*sim).states[a].level < (*sim).states[b].level;
+        case REFERENCE_PRIORITY:
+            return priority_key(sim, a) < priority_key(sim, b) || (priority_key(sim, a) == priority_key(sim, b) && a < b);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * True when the running process should give way after its tick
+ */
+static int should_preempt(_simulation* sim, _reference_policy policy, const _reference_queues* queues, uint32_t active)
+{
+    _process_state* state = &(*sim).states[active];
+    uint32_t next = (*queues).readyLength ? (*queues).ready[0] : NO_PROCESS;
+    switch (policy){
+        case REFERENCE_RR:
+            return (*state).quantum == 0 && next != NO_PROCESS;
+        case REFERENCE_SRTF:
+            return next != NO_PROCESS && remaining(sim, next) < remaining(sim, active);
+        case REFERENCE_MLFQ:
+            if ((*state).quantum == 0){
+                if ((*state).level + 1 < MLFQ_LEVELS){
+                    (*state).level++;
+                }
+                (*state).quantum = (int32_t) ((*sim).quantum << (*state).level);
+                return next != NO_PROCESS;
+            }
+            return next != NO_PROCESS && (*sim).states[next].level < (*state).level;
+        case REFERENCE_PRIORITY:
+            return next != NO_PROCESS && priority_key(sim, next) < priority_key(sim, active);
+        default:
+            return 0;
+    }
+}
+
+static void queue_ready(_simulation* sim, _reference_policy policy, _reference_queues* queues, uint32_t process)
+{
+    uint32_t slot = (*queues).readyLength++;
+    (*sim).states[process].status = 1;
+    (*sim).states[process].readySinceCycle = (*sim).currentCycle;
+    PROFILE_COUNT(sim, readyInserts, 1);
+    if (policy != REFERENCE_FCFS && policy != REFERENCE_RR){
+        for (; slot && runs_before(sim, policy, process, (*queues).ready[slot - 1]); slot--){
+            (*queues).ready[slot] = (*queues).ready[slot - 1];
+            PROFILE_COUNT(sim, listSteps, 1);
+        }
+    }
+    (*queues).ready[slot] = process;
+}
+
+/**
+ * Blocks process behind every blocked process with no more I/O left than it
+ */
+static void queue_blocked(_simulation* sim, _reference_queues* queues, uint32_t process)
+{
+    uint32_t slot = (*queues).blockedLength++;
+    (*sim).states[process].status = 3;
+    (*queues).ioLeft[process] = (*sim).states[process].IOBurst;
+    PROFILE_COUNT(sim, blockedInserts, 1);
+    for (; slot && (*queues).ioLeft[(*queues).blocked[slot - 1]] > (*queues).ioLeft[process]; slot--){
+        (*queues).blocked[slot] = (*queues).blocked[slot - 1];
+        PROFILE_COUNT(sim, listSteps, 1);
+    }
+    (*queues).blocked[slot] = process;
+}
+
+static void dispatch(_simulation* sim, _reference_policy policy, uint32_t process)
+{
+    const _process_spec* spec = &(*sim).specs[process];
+    _process_state* state = &(*sim).states[process];
+    if ((*state).isFirstTimeRunning){
+        (*state).isFirstTimeRunning = false;
+        (*sim).totalStartedProcesses++;
+    }
+    (*state).status = 2;
+    PROFILE_COUNT(sim, dispatches, 1);
+    if (policy == REFERENCE_MLFQ){
+        (*state).quantum = (int32_t) ((*sim).quantum << (*state).level);
+    }
+    if (!(*state).CPUBurst){
+        uint32_t burst_time = randomOS((*spec).B, process, (*sim).randomSource);
+        PROFILE_COUNT(sim, randomLookups, 1);
+        uint32_t time = (*spec).C - (*state).currentCPUTimeRun;
+        if (time < burst_time){
+            (*state).CPUBurst = time;
+        }
+        else{
+            (*state).CPUBurst = burst_time;
+            (*state).IOBurst = burst_time * (*spec).M;
+        }
+    }
+}
+
+static int reference_run(_simulation* sim, _reference_policy policy)
+{
+    uint32_t count = (*sim).totalCreatedProcesses, active = NO_PROCESS;
+    _reference_queues queues;
+    memset(&queues, 0, sizeof(queues));
+    queues.ready = malloc((count ? count : 1) * sizeof(uint32_t));
+    queues.blocked = malloc((count ? count : 1) * sizeof(uint32_t));
+    queues.ioLeft = malloc((count ? count : 1) * sizeof(uint32_t));
+    if (!queues.ready || !queues.blocked || !queues.ioLeft){
+        free(queues.ready);
+        free(queues.blocked);
+        free(queues.ioLeft);
+        return -1;
+    }
+
+    while ((*sim).totalFinishedProcesses < count){
+        // I/O ticks for everything blocked; processes that run out wake in list order
+        if (queues.blockedLength){
+            uint32_t kept = 0;
+            (*sim).totalCyclesSpentBlocked += 1;
+            PROFILE_COUNT(sim, unblockChecks, queues.blockedLength);
+            for (uint32_t i = 0; i < queues.blockedLength; i++){
+                uint32_t process = queues.blocked[i];
+                if (queues.ioLeft[process]){
+                    queues.ioLeft[process] -= 1;
+                    (*sim).stats[process].currentIOBlockedTime += 1;
+                }
+                if (queues.ioLeft[process]){
+                    queues.blocked[kept++] = process;
+                }
+                else{
+                    queue_ready(sim, policy, &queues, process);
+                }
+            }
+            queues.blockedLength = kept;
+        }
+        PROFILE_COUNT(sim, arrivalChecks, count);
+        for (uint32_t i = 0; i < count; i++){
+            if ((*sim).specs[i].A == (*sim).currentCycle){
+                queue_ready(sim, policy, &queues, i);
+            }
+        }
+        if (active != NO_PROCESS){
+            _process_state* state = &(*sim).states[active];
+            (*state).CPUBurst -= 1;
+            (*state).currentCPUTimeRun += 1;
+            if (policy == REFERENCE_RR || policy == REFERENCE_MLFQ){
+                (*state).quantum -= 1;
+            }
+            if ((*state).currentCPUTimeRun == (*sim).specs[active].C){
+                (*sim).stats[active].finishingTime = (*sim).currentCycle;
+                (*state).status = 4;
+                process_finished(sim, active);
+                active = NO_PROCESS;
+            }
+            else if ((*state).CPUBurst == 0){
+                (*state).quantum = (*sim).quantum;
+                queue_blocked(sim, &queues, active);
+                active = NO_PROCESS;
+            }
+            else if (should_preempt(sim, policy, &queues, active)){
+                PROFILE_COUNT(sim, preemptions, 1);
+                if (policy == REFERENCE_RR){
+                    (*state).quantum = (*sim).quantum;
+                }
+                queue_ready(sim, policy, &queues, active);
+                active = NO_PROCESS;
+            }
+        }
+        if (queues.readyLength && active == NO_PROCESS){
+            active = queues.ready[0];
+            memmove(queues.ready, queues.ready + 1, --queues.readyLength * sizeof(uint32_t));
+            dispatch(sim, policy, active);
+        }
+        for (uint32_t i = 0; i < queues.readyLength; i++){
+            (*sim).stats[queues.ready[i]].currentWaitingTime += 1;
+        }
+        (*sim).currentCycle += 1;
+        (*sim).eventCount += 1;
+    }
+    free(queues.ready);
+    free(queues.blocked);
+    free(queues.ioLeft);
+    return 0;
+}
+
+int reference_FCFS(_simulation* sim)
+{
+    return reference_run(sim, REFERENCE_FCFS);
+}
+
+int reference_RR(_simulation* sim)
+{
+    return reference_run(sim, REFERENCE_RR);
+}
+
+int reference_SJF(_simulation* sim)
+{
+    return reference_run(sim, REFERENCE_SJF);
+}
+
+int reference_SRTF(_simulation* sim)
+{
+    return reference_run(sim, REFERENCE_SRTF);
+}
+
+int reference_MLFQ(_simulation* sim)
+{
+    return reference_run(sim, REFERENCE_MLFQ);
+}
+
+int reference_PRIORITY(_simulation* sim)
+{
+    return reference_run(sim, REFERENCE_PRIORITY);
+}
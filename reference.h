@@ -0,0 +1,20 @@
+#ifndef REFERENCE_H
+#define REFERENCE_H
+
+#include "scheduler.h"
+
+/*
+ * The reference engine steps through every cycle and keeps its queues as plain arrays, the way the
+ * original scheduler did with linked lists. It shares nothing with the event-driven engine beyond
+ * the process tables and randomOS, so --reference can cross-check every optimisation of the fast
+ * path. It is far too slow for large workloads. Each returns 0 once the run is complete, -1 if its
+ * queues can't be allocated.
+ */
+int reference_FCFS(_simulation* sim);
+int reference_RR(_simulation* sim);
+int reference_SJF(_simulation* sim);
+int reference_SRTF(_simulation* sim);
+int reference_MLFQ(_simulation* sim);
+int reference_PRIORITY(_simulation* sim);
+
+#endif
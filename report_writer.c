@@ -0,0 +1,115 @@
+#include "report_writer.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+int report_writer_init(_report_writer* writer, FILE* out)
+{
+    (*writer).buffer = malloc(REPORT_WRITER_CHUNK_SIZE);
+    (*writer).length = 0;
+    (*writer).capacity = (*writer).buffer ? REPORT_WRITER_CHUNK_SIZE : 0;
+    (*writer).out = out;
+    (*writer).failed = (*writer).buffer ? 0 : 1;
+    return (*writer).failed ? -1 : 0;
+}
+
+void report_writer_flush(_report_writer* writer)
+{
+    if (!(*writer).out || !(*writer).length){
+        return;
+    }
+    if (fwrite((*writer).buffer, 1, (*writer).length, (*writer).out) != (*writer).length){
+        (*writer).failed = 1;
+    }
+    (*writer).length = 0;
+}
+
+int report_writer_reserve(_report_writer* writer, size_t size)
+{
+    if ((*writer).failed){
+        return -1;
+    }
+    if ((*writer).out){
+        report_writer_flush(writer);
+    }
+    if ((*writer).capacity - (*writer).length >= size){
+        return 0;
+    }
+
+    size_t capacity = (*writer).capacity ? (*writer).capacity : REPORT_WRITER_CHUNK_SIZE;
+    while (capacity - (*writer).length < size){
+        capacity *= 2;
+    }
+    char* larger = realloc((*writer).buffer, capacity);
+    if (!larger){
+        (*writer).failed = 1;
+        return -1;
+    }
+    (*writer).buffer = larger;
+    (*writer).capacity = capacity;
+    return 0;
+}
+
+int report_writer_close(_report_writer* writer)
+{
+    report_writer_flush(writer);
+    free((*writer).buffer);
+    (*writer).buffer = NULL;
+    (*writer).length = (*writer).capacity = 0;
+    return (*writer).failed ? -1 : 0;
+}
+
+char* report_writer_take(_report_writer* writer, size_t* length)
+{
+    char* text = (*writer).buffer;
+    *length = (*writer).length;
+    (*writer).buffer = NULL;
+    (*writer).length = (*writer).capacity = 0;
+    if ((*writer).failed){
+        free(text);
+        return NULL;
+    }
+    return text;
+}
+
+#define FIXED6_EXACT_LIMIT 8796093022208.0    // 2^43: below this magnitude * 10^6 fits in 64 bits
+
+void report_fixed6(_report_writer* writer, double value)
+{
+    double magnitude = fabs(value);
+    if (!(magnitude < FIXED6_EXACT_LIMIT)){
+        char text[512];
+        int length = snprintf(text, sizeof(text), "%6f", value);
+        report_bytes(writer, text, length > 0 ? (size_t) length : 0);
+        return;
+    }
+
+    // magnitude is exactly mantissa * 2^-shift, so magnitude * 10^6 can be rounded exactly,
+    // half to even as glibc does, rather than through an inexact floating point multiply
+    int exponent;
+    uint64_t mantissa = (uint64_t) ldexp(frexp(magnitude, &exponent), 53);
+    int shift = 53 - exponent;
+    unsigned __int128 scaled = (unsigned __int128) mantissa * 1000000u;
+    uint64_t units = 0;
+    if (mantissa && shift < 128){
+        unsigned __int128 half = (unsigned __int128) 1 << (shift - 1);
+        unsigned __int128 remainder = scaled & ((half << 1) - 1);
+        units = (uint64_t) (scaled >> shift);
+        if (remainder > half || (remainder == half && (units & 1))){
+            units++;
+        }
+    }
+
+    char fraction[7];
+    uint64_t digits = units % 1000000;
+    for (int i = 5; i >= 0; i--){
+        fraction[i + 1] = (char) ('0' + digits % 10);
+        digits /= 10;
+    }
+    fraction[0] = '.';
+    if (signbit(value)){
+        report_char(writer, '-');
+    }
+    report_uint(writer, units / 1000000);
+    report_bytes(writer, fraction, sizeof(fraction));
+}
@@ -0,0 +1,103 @@
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define REPORT_WRITER_CHUNK_SIZE (1 << 16)  // Bytes buffered before a chunk is written out
+
+/*
+ * Formats a report into one reusable buffer and writes it out a chunk at a time, so a report
+ * costs one fwrite per chunk rather than one printf per line. Without a stream the buffer
+ * grows instead and keeps the whole report.
+ */
+typedef struct ReportWriter {
+    char* buffer;                       // The formatted text not yet written out
+    size_t length;                      // The number of bytes in the buffer
+    size_t capacity;                    // The size of the buffer
+    FILE* out;                          // Where full chunks go (NULL keeps the report in memory)
+    int failed;                         // Set once a write or an allocation has failed
+} _report_writer;
+
+/**
+ * Starts a report written to out, or kept in memory when out is NULL.
+ * Returns 0 on success, -1 if the buffer can't be allocated.
+ */
+int report_writer_init(_report_writer* writer, FILE* out);
+
+/**
+ * Makes room for size more bytes, writing out or growing the buffer. Returns 0 on success, -1 otherwise.
+ */
+int report_writer_reserve(_report_writer* writer, size_t size);
+
+/**
+ * Writes out whatever is buffered (nothing happens for an in-memory report)
+ */
+void report_writer_flush(_report_writer* writer);
+
+/**
+ * Flushes and releases the buffer. Returns 0 if everything was written, -1 otherwise.
+ */
+int report_writer_close(_report_writer* writer);
+
+/**
+ * Ends an in-memory report and hands its text to the caller, who frees it.
+ * Returns NULL (and frees the text) if anything failed.
+ */
+char* report_writer_take(_report_writer* writer, size_t* length);
+
+/**
+ * Appends value as printf's "%6f" would print it
+ */
+void report_fixed6(_report_writer* writer, double value);
+
+static inline void report_bytes(_report_writer* writer, const char* text, size_t length)
+{
+    if ((*writer).capacity - (*writer).length < length && report_writer_reserve(writer, length) != 0){
+        return;
+    }
+    memcpy((*writer).buffer + (*writer).length, text, length);
+    (*writer).length += length;
+}
+
+static inline void report_text(_report_writer* writer, const char* text)
+{
+    report_bytes(writer, text, strlen(text));
+}
+
+static inline void report_char(_report_writer* writer, char c)
+{
+    report_bytes(writer, &c, 1);
+}
+
+/**
+ * Appends value in decimal, as "%u"
+ */
+static inline void report_uint(_report_writer* writer, uint64_t value)
+{
+    char digits[20];
+    size_t start = sizeof(digits);
+    do {
+        digits[--start] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value);
+    report_bytes(writer, digits + start, sizeof(digits) - start);
+}
+
+/**
+ * Appends value in decimal, as "%i"
+ */
+static inline void report_int(_report_writer* writer, int32_t value)
+{
+    if (value < 0){
+        report_char(writer, '-');
+        report_uint(writer, (uint64_t) -(int64_t) value);
+    }
+    else{
+        report_uint(writer, (uint64_t) value);
+    }
+}
+
+#endif
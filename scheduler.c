@@ -2,44 +2,27 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <errno.h>
 
-// Headers as needed
-
-typedef enum {false, true} bool;        // Allows boolean types in C
-
-/* Defines a job struct */
-typedef struct Process {
-    uint32_t A;                         // A: Arrival time of the process
-    uint32_t B;                         // B: Upper Bound of CPU burst times of the given random integer list
-    uint32_t C;                         // C: Total CPU time required
-    uint32_t M;                         // M: Multiplier of CPU burst time
-    uint32_t processID;                 // The process ID given upon input read
-
-    uint8_t status;                     // 0 is unstarted, 1 is ready, 2 is running, 3 is blocked, 4 is terminated
-
-    int32_t finishingTime;              // The cycle when the the process finishes (initially -1)
-    uint32_t currentCPUTimeRun;         // The amount of time the process has already run (time in running state)
-    uint32_t currentIOBlockedTime;      // The amount of time the process has been IO blocked (time in blocked state)
-    uint32_t currentWaitingTime;        // The amount of time spent waiting to be run (time in ready state)
-
-    uint32_t IOBurst;                   // The amount of time until the process finishes being blocked
-    uint32_t CPUBurst;                  // The CPU availability of the process (has to be > 1 to move to running)
+#include <getopt.h>
+#include <sys/stat.h>
 
-    int32_t quantum;                    // Used for schedulers that utilise pre-emption
+#include "scheduler.h"
+#include "thread_pool.h"
+#include "batch.h"
+#include "bench.h"
+#include "report_writer.h"
+#include "workload_reader.h"
+#include "reference.h"
+#include "smp.h"
+#include "policy.h"
+#include "policies.h"
+#include "ensemble.h"
+#include "open_system.h"
+#include "checkpoint.h"
+#include "server.h"
 
-    bool isFirstTimeRunning;            // Used to check when to calculate the CPU burst when it hits running mode
-
-    struct Process* nextInBlockedList;  // A pointer to the next process available in the blocked list
-    struct Process* nextInReadyQueue;   // A pointer to the next process available in the ready queue
-    struct Process* nextInReadySuspendedQueue; // A pointer to the next process available in the ready suspended queue
-} _process;
-
-
-uint32_t CURRENT_CYCLE = 0;             // The current cycle that each process is on
-uint32_t TOTAL_CREATED_PROCESSES = 0;   // The total number of processes constructed
-uint32_t TOTAL_STARTED_PROCESSES = 0;   // The total number of processes that have started being simulated
-uint32_t TOTAL_FINISHED_PROCESSES = 0;  // The total number of processes that have finished running
-uint32_t TOTAL_NUMBER_OF_CYCLES_SPENT_BLOCKED = 0; // The total cycles in the blocked state
+// Headers as needed
 
 const char* RANDOM_NUMBER_FILE_NAME= "random-numbers";
 const uint32_t SEED_VALUE = 200;  // Seed value for reading from file
@@ -48,25 +31,11 @@ const uint32_t SEED_VALUE = 200;  // Seed value for reading from file
 
 
 /**
- * Reads a random non-negative integer X from a file with a given line named random-numbers (in the current directory)
+ * Reads a random non-negative integer X from the given line of random-numbers (in the current directory).
+ * The file is loaded once into random_source, so this is a table lookup rather than a rescan of the file.
  */
-uint32_t getRandNumFromFile(uint32_t line, FILE* random_num_file_ptr){
-    uint32_t end, loop;
-    char str[512];
-
-    rewind(random_num_file_ptr); // reset to be beginning
-    for(end = loop = 0;loop<line;++loop){
-        if(0==fgets(str, sizeof(str), random_num_file_ptr)){ //include '\n'
-            end = 1;  //can't input (EOF)
-            break;
-        }
-    }
-    if(!end) {
-        return (uint32_t) atoi(str);
-    }
-
-    // fail-safe return
-    return (uint32_t) 1804289383;
+uint32_t getRandNumFromFile(uint32_t line, const _random_source* random_source){
+    return random_source_line(random_source, line);
 }
 
 
@@ -75,11 +44,9 @@ uint32_t getRandNumFromFile(uint32_t line, FILE* random_num_file_ptr){
  * Reads a random non-negative integer X from a file named random-numbers.
  * Returns the CPU Burst: : 1 + (random-number-from-file % upper_bound)
  */
-uint32_t randomOS(uint32_t upper_bound, uint32_t process_indx, FILE* random_num_file_ptr)
+uint32_t randomOS(uint32_t upper_bound, uint32_t process_indx, const _random_source* random_source)
 {
-    char str[20];
-    
-    uint32_t unsigned_rand_int = (uint32_t) getRandNumFromFile(SEED_VALUE+process_indx, random_num_file_ptr);
+    uint32_t unsigned_rand_int = getRandNumFromFile(SEED_VALUE+process_indx, random_source);
     uint32_t returnValue = 1 + (unsigned_rand_int % upper_bound);
 
     return returnValue;
@@ -90,549 +57,1252 @@ uint32_t randomOS(uint32_t upper_bound, uint32_t process_indx, FILE* random_num_
 
 
 /**
- * Prints to standard output the original input
- * process_list is the original processes inputted (in array form)
+ * Appends " ( A B C M)" for spec, as printf(" ( %i %i %i %i)") would
+ */
+static void report_spec(_report_writer* out, const _process_spec* spec)
+{
+    report_bytes(out, " ( ", 3);
+    report_int(out, (int32_t) (*spec).A);
+    report_char(out, ' ');
+    report_int(out, (int32_t) (*spec).B);
+    report_char(out, ' ');
+    report_int(out, (int32_t) (*spec).C);
+    report_char(out, ' ');
+    report_int(out, (int32_t) (*spec).M);
+    report_char(out, ')');
+}
+
+/**
+ * Prints the original input to out
+ * sim is the finished run, whose processes are in input order
  */
-void printStart(_process process_list[])
+void printStart(const _simulation* sim, _report_writer* out)
 {
-    printf("The original input was: %i", TOTAL_CREATED_PROCESSES);
+    const _process_spec* process_list = (*sim).specs;
+    report_text(out, "The original input was: ");
+    report_int(out, (int32_t) (*sim).totalCreatedProcesses);
 
     uint32_t i = 0;
-    for (; i < TOTAL_CREATED_PROCESSES; ++i)
+    for (; i < (*sim).totalCreatedProcesses; ++i)
     {
-        printf(" ( %i %i %i %i)", process_list[i].A, process_list[i].B,
-               process_list[i].C, process_list[i].M);
+        report_spec(out, &process_list[i]);
     }
-    printf("\n");
+    report_char(out, '\n');
 } 
 
 /**
- * Prints to standard output the final output
- * finished_process_list is the terminated processes (in array form) in the order they each finished in.
+ * Prints the final output to out
+ * sim is the finished run, whose completionOrder lists the processes in the order they each finished in.
  */
-void printFinal(_process finished_process_list[])
+void printFinal(const _simulation* sim, _report_writer* out)
 {
-    printf("The (sorted) input is: %i", TOTAL_CREATED_PROCESSES);
+    const _process_spec* process_list = (*sim).specs;
+    const uint32_t* completion_order = (*sim).completionOrder;
+    report_text(out, "The (sorted) input is: ");
+    report_int(out, (int32_t) (*sim).totalCreatedProcesses);
 
     uint32_t i = 0;
-    for (; i < TOTAL_FINISHED_PROCESSES; ++i)
+    for (; i < (*sim).totalFinishedProcesses; ++i)
     {
-        printf(" ( %i %i %i %i)", finished_process_list[i].A, finished_process_list[i].B,
-               finished_process_list[i].C, finished_process_list[i].M);
+        report_spec(out, &process_list[completion_order[i]]);
     }
-    printf("\n");
+    report_char(out, '\n');
 } // End of the print final function
 
 /**
  * Prints out specifics for each process.
- * @param process_list The original processes inputted, in array form
+ * @param sim The finished run, whose processes are in input order
+ * @param out The writer the report is formatted into
  */
-void printProcessSpecifics(_process process_list[])
+void printProcessSpecifics(const _simulation* sim, _report_writer* out)
 {
+    const _process_spec* process_list = (*sim).specs;
+    const _process_stats* stats = (*sim).stats;
     uint32_t i = 0;
-    printf("\n");
-    for (; i < TOTAL_CREATED_PROCESSES; ++i)
+    report_char(out, '\n');
+    for (; i < (*sim).totalCreatedProcesses; ++i)
     {
-        printf("Process %i:\n", process_list[i].processID);
-        printf("\t(A,B,C,M) = (%i,%i,%i,%i)\n", process_list[i].A, process_list[i].B,
-               process_list[i].C, process_list[i].M);
-        printf("\tFinishing time: %i\n", process_list[i].finishingTime);
-        printf("\tTurnaround time: %i\n", process_list[i].finishingTime - process_list[i].A);
-        printf("\tI/O time: %i\n", process_list[i].currentIOBlockedTime);
-        printf("\tWaiting time: %i\n", process_list[i].currentWaitingTime);
-        printf("\n");
+        report_text(out, "Process ");
+        report_int(out, (int32_t) i);
+        report_text(out, ":\n\t(A,B,C,M) = (");
+        report_int(out, (int32_t) process_list[i].A);
+        report_char(out, ',');
+        report_int(out, (int32_t) process_list[i].B);
+        report_char(out, ',');
+        report_int(out, (int32_t) process_list[i].C);
+        report_char(out, ',');
+        report_int(out, (int32_t) process_list[i].M);
+        report_text(out, ")\n\tFinishing time: ");
+        report_int(out, stats[i].finishingTime);
+        report_text(out, "\n\tTurnaround time: ");
+        report_int(out, (int32_t) (stats[i].finishingTime - process_list[i].A));
+        report_text(out, "\n\tI/O time: ");
+        report_int(out, (int32_t) stats[i].currentIOBlockedTime);
+        report_text(out, "\n\tWaiting time: ");
+        report_int(out, (int32_t) stats[i].currentWaitingTime);
+        report_text(out, "\n\n");
     }
 } // End of the print process specifics function
 
 /**
- * Prints out the summary data
- * process_list The original processes inputted, in array form
+ * Computes the summary data for a finished run
  */
-void printSummaryData(_process process_list[])
+void compute_summary(const _simulation* sim, _summary_data* summary)
 {
+    const _process_spec* process_list = (*sim).specs;
+    const _process_state* states = (*sim).states;
+    const _process_stats* stats = (*sim).stats;
     uint32_t i = 0;
     double total_amount_of_time_utilizing_cpu = 0.0;
     double total_amount_of_time_io_blocked = 0.0;
     double total_amount_of_time_spent_waiting = 0.0;
     double total_turnaround_time = 0.0;
-    uint32_t final_finishing_time = CURRENT_CYCLE - 1;
-    for (; i < TOTAL_CREATED_PROCESSES; ++i)
+    uint32_t final_finishing_time = (*sim).currentCycle - 1;
+    for (; i < (*sim).totalCreatedProcesses; ++i)
     {
-        total_amount_of_time_utilizing_cpu += process_list[i].currentCPUTimeRun;
-        total_amount_of_time_io_blocked += process_list[i].currentIOBlockedTime;
-        total_amount_of_time_spent_waiting += process_list[i].currentWaitingTime;
-        total_turnaround_time += (process_list[i].finishingTime - process_list[i].A);
+        total_amount_of_time_utilizing_cpu += states[i].currentCPUTimeRun;
+        total_amount_of_time_io_blocked += stats[i].currentIOBlockedTime;
+        total_amount_of_time_spent_waiting += stats[i].currentWaitingTime;
+        total_turnaround_time += (stats[i].finishingTime - process_list[i].A);
     }
 
+    (*summary).finishingTime = final_finishing_time;
+
     // Calculates the CPU utilisation
-    double cpu_util = total_amount_of_time_utilizing_cpu / final_finishing_time;
+    (*summary).cpuUtilisation = total_amount_of_time_utilizing_cpu / final_finishing_time;
 
     // Calculates the IO utilisation
-    double io_util = (double) TOTAL_NUMBER_OF_CYCLES_SPENT_BLOCKED / final_finishing_time;
+    (*summary).ioUtilisation = (double) (*sim).totalCyclesSpentBlocked / final_finishing_time;
 
     // Calculates the throughput (Number of processes over the final finishing time times 100)
-    double throughput =  100 * ((double) TOTAL_CREATED_PROCESSES/ final_finishing_time);
+    (*summary).throughput =  100 * ((double) (*sim).totalCreatedProcesses/ final_finishing_time);
 
     // Calculates the average turnaround time
-    double avg_turnaround_time = total_turnaround_time / TOTAL_CREATED_PROCESSES;
+    (*summary).averageTurnaroundTime = total_turnaround_time / (*sim).totalCreatedProcesses;
 
     // Calculates the average waiting time
-    double avg_waiting_time = total_amount_of_time_spent_waiting / TOTAL_CREATED_PROCESSES;
-
-    printf("Summary Data:\n");
-    printf("\tFinishing time: %i\n", CURRENT_CYCLE - 1);
-    printf("\tCPU Utilisation: %6f\n", cpu_util);
-    printf("\tI/O Utilisation: %6f\n", io_util);
-    printf("\tThroughput: %6f processes per hundred cycles\n", throughput);
-    printf("\tAverage turnaround time: %6f\n", avg_turnaround_time);
-    printf("\tAverage waiting time: %6f\n", avg_waiting_time);
+    (*summary).averageWaitingTime = total_amount_of_time_spent_waiting / (*sim).totalCreatedProcesses;
+} // End of the compute summary function
+
+/**
+ * Prints out the summary data
+ * sim The finished run, out the writer the report is formatted into
+ */
+void printSummaryData(const _simulation* sim, _report_writer* out)
+{
+    _summary_data summary;
+    compute_summary(sim, &summary);
+    printSummary(&summary, out);
 } // End of the print summary data function
 
-#define COMMANDLINE_INPUT_LENGTH 128
-uint32_t QUANTUM = 2;
-int debug = 0;
+/**
+ * Prints out summary as the Summary Data block
+ */
+void printSummary(const _summary_data* summary, _report_writer* out)
+{
+    report_text(out, "Summary Data:\n\tFinishing time: ");
+    report_int(out, (int32_t) (*summary).finishingTime);
+    report_text(out, "\n\tCPU Utilisation: ");
+    report_fixed6(out, (*summary).cpuUtilisation);
+    report_text(out, "\n\tI/O Utilisation: ");
+    report_fixed6(out, (*summary).ioUtilisation);
+    report_text(out, "\n\tThroughput: ");
+    report_fixed6(out, (*summary).throughput);
+    report_text(out, " processes per hundred cycles\n\tAverage turnaround time: ");
+    report_fixed6(out, (*summary).averageTurnaroundTime);
+    report_text(out, "\n\tAverage waiting time: ");
+    report_fixed6(out, (*summary).averageWaitingTime);
+    report_char(out, '\n');
+}
 
 /**
- * The magic starts from here
+ * Prints out how the work of a multi-CPU run was spread over its CPUs
+ * sim The finished run, out the writer the report is formatted into
  */
-int main(int argc, char *argv[])
+void printSMPData(const _simulation* sim, _report_writer* out)
 {
-    uint32_t total_num_of_process; // Read from the file -- number of process to create
-    // Other variables
-    int A, B, C, M;
+    uint32_t final_finishing_time = (*sim).currentCycle - 1;
+    uint64_t total_busy_cycles = 0;
 
-    // Write code for your shiny scheduler
-    if(debug){
-        printf("argc = %i, argv[0] = %s\n", argc, argv[0]);
-        printf("argc = %i, argv[1] = %s\n", argc, argv[1]);
+    report_text(out, "SMP Data:\n\tCPUs: ");
+    report_uint(out, (*sim).cpuCount);
+    report_char(out, '\n');
+    for (uint32_t c = 0; c < (*sim).cpuCount; c++){
+        const _core_stats* core = &(*sim).cores[c];
+        total_busy_cycles += (*core).busyCycles;
+        report_text(out, "\tCPU ");
+        report_uint(out, c);
+        report_text(out, ": utilisation ");
+        report_fixed6(out, (double) (*core).busyCycles / final_finishing_time);
+        report_text(out, ", ");
+        report_uint(out, (*core).dispatches);
+        report_text(out, " dispatches, ");
+        report_uint(out, (*core).steals);
+        report_text(out, " steals, ");
+        report_uint(out, (*core).finished);
+        report_text(out, " finished\n");
     }
-    
-    if(argc > 1)
-    {
-        FILE* fp = fopen(argv[1], "r");
-        if (fp == NULL){
-            printf("%s not found\n", argv[1]);
-            return -1;
-        }
-        FILE* randomFile = fopen(RANDOM_NUMBER_FILE_NAME, "r");
-        if (randomFile == NULL){
-            printf("%s not found\n", RANDOM_NUMBER_FILE_NAME);
-            return -1;
-        }
-        char fileInput[COMMANDLINE_INPUT_LENGTH];
-        fscanf(fp, "%u", &total_num_of_process);
-        _process process_list[total_num_of_process]; // Creates a container for all processes
-        _process finished_processes[total_num_of_process];
-        for (int i = 0; i < total_num_of_process; i++){
-            fscanf(fp, " (%i %i %i %i) ", &A, &B, &C, &M);
-            if(debug){
-                printf("A: %i, B: %i, C: %i, M: %i\n",A,B,C,M);
-            }
-            process_list[i].A = A;
-            process_list[i].B = B;
-            process_list[i].C = C;
-            process_list[i].M = M;
-            process_list[i].processID = i;
-            TOTAL_CREATED_PROCESSES += 1;
-        }
-        fclose(fp);
-
-        // FCFS---------------------------------------------------------------------------------
-
-        TOTAL_STARTED_PROCESSES = TOTAL_FINISHED_PROCESSES = TOTAL_NUMBER_OF_CYCLES_SPENT_BLOCKED = CURRENT_CYCLE =  0;
-        initialize_processes(process_list);
-        printf("\n######################### START OF FIRST COME FIRST SERVE #########################\n");
-        
-        FCFS(process_list, finished_processes, randomFile);
-        printStart(process_list);
-        printFinal(finished_processes);
-        printf("\nThe scheduling algorithm used was First Come First Serve\n");
-        printProcessSpecifics(process_list);
-        printSummaryData(process_list);
-        printf("######################### END OF FIRST COME FIRST SERVE #########################");
-
-        // RR ---------------------------------------------------------------------------------
-
-        TOTAL_STARTED_PROCESSES = TOTAL_FINISHED_PROCESSES = TOTAL_NUMBER_OF_CYCLES_SPENT_BLOCKED = CURRENT_CYCLE =  0;
-        initialize_processes(process_list);
-        printf("\n######################### START OF ROUND ROBIN #########################\n");
-        
-        RR(process_list, finished_processes, randomFile);
-        printStart(process_list);
-        printFinal(finished_processes);
-        printf("\nThe scheduling algorithm used was Round Robin\n");
-        printProcessSpecifics(process_list);
-        printSummaryData(process_list);
-        printf("######################### END OF ROUND ROBIN #########################");
-
-        //SJF ---------------------------------------------------------------------------------
-
-        TOTAL_STARTED_PROCESSES = TOTAL_FINISHED_PROCESSES = TOTAL_NUMBER_OF_CYCLES_SPENT_BLOCKED = CURRENT_CYCLE =  0;
-        initialize_processes(process_list);
-        printf("\n######################### START OF SHORTEST JOB FIRST #########################\n");
-        
-        SJF(process_list, finished_processes, randomFile);
-        printStart(process_list);
-        printFinal(finished_processes);
-        printf("\nThe scheduling algorithm used was Shortest Job First\n");
-        printProcessSpecifics(process_list);
-        printSummaryData(process_list);
-        printf("######################### END OF SHORTEST JOB FIRST #########################\n");
-
-        fclose(randomFile);
+    report_text(out, "\tMean CPU utilisation: ");
+    report_fixed6(out, (double) total_busy_cycles / final_finishing_time / (*sim).cpuCount);
+    report_text(out, "\n\tMigrations: ");
+    report_uint(out, (*sim).migrations);
+    report_text(out, "\n\tAggregate throughput: ");
+    report_fixed6(out, 100 * ((double) (*sim).totalFinishedProcesses / final_finishing_time));
+    report_text(out, " processes per hundred cycles\n");
+} // End of the print SMP data function
+
+/**
+ * Prints the turnaround and waiting time percentiles of a finished run and their histograms.
+ * They come from the run's streaming histograms, so each is exact to within 1/64 of its value.
+ */
+void printLatencyData(const _simulation* sim, _report_writer* out)
+{
+    report_text(out, "\nLatency Data:\n");
+    printPercentiles((*sim).turnaroundHistogram, "Turnaround time", out);
+    printPercentiles((*sim).waitingHistogram, "Waiting time", out);
+    printHistogram((*sim).turnaroundHistogram, "Turnaround time", out);
+    printHistogram((*sim).waitingHistogram, "Waiting time", out);
+} // End of the print latency data function
+
+const _scheduling_algorithm ALGORITHMS[ALGORITHM_COUNT] = {
+    { "First Come First Serve", "FIRST COME FIRST SERVE", "fcfs", false, &FCFS_POLICY, FCFS, reference_FCFS },
+    { "Round Robin", "ROUND ROBIN", "rr", true, &RR_POLICY, RR, reference_RR },
+    { "Shortest Job First", "SHORTEST JOB FIRST", "sjf", false, &SJF_POLICY, SJF, reference_SJF },
+    { "Shortest Remaining Time First", "SHORTEST REMAINING TIME FIRST", "srtf", false, &SRTF_POLICY, SRTF, reference_SRTF },
+    { "Multi-Level Feedback Queue", "MULTI-LEVEL FEEDBACK QUEUE", "mlfq", true, &MLFQ_POLICY, MLFQ, reference_MLFQ },
+    { "Priority with Aging", "PRIORITY WITH AGING", "priority", false, &PRIORITY_POLICY, PRIORITY, reference_PRIORITY },
+};
+
+int run_and_report(const _scheduling_algorithm* algorithm, _simulation* sim, _report_writer* out)
+{
+    PROFILE_START(start);
+    int status = (*sim).cpuCount ? smp_simulate(sim, (*algorithm).policy) : (*algorithm).run(sim);
+    PROFILE_STOP((*sim).profile, PROFILE_SIMULATE, start);
+    if (status != 0){
+        return -1;
     }
+    write_report(algorithm, sim, out);
     return 0;
 }
 
-void initialize_processes(_process process_list[]){
-    for (int i = 0; i < TOTAL_CREATED_PROCESSES; i++){
-        process_list[i].status = 0;
-        process_list[i].finishingTime = -1;
-        process_list[i].currentCPUTimeRun = 0;
-        process_list[i].currentIOBlockedTime = 0;
-        process_list[i].currentWaitingTime = 0;
-        process_list[i].IOBurst = 0;
-        process_list[i].CPUBurst = 0;
-        process_list[i].quantum = 2;
-        process_list[i].isFirstTimeRunning = true;
-        process_list[i].nextInBlockedList = NULL;
-        process_list[i].nextInReadyQueue = NULL;
-        process_list[i].nextInReadySuspendedQueue = NULL;
+void write_report(const _scheduling_algorithm* algorithm, const _simulation* sim, _report_writer* out)
+{
+    PROFILE_START(start);
+    report_text(out, "\n######################### START OF ");
+    report_text(out, (*algorithm).banner);
+    report_text(out, " #########################\n");
+
+    if ((*sim).reportFlags & REPORT_PROCESSES){
+        printStart(sim, out);
+        printFinal(sim, out);
+    }
+    report_text(out, "\nThe scheduling algorithm used was ");
+    report_text(out, (*algorithm).name);
+    if ((*algorithm).usesQuantum && (*sim).quantum != QUANTUM){
+        report_text(out, " (quantum ");     // Only off the default, so default reports keep their original form
+        report_uint(out, (*sim).quantum);
+        report_char(out, ')');
+    }
+    report_char(out, '\n');
+    if ((*sim).reportFlags & REPORT_PROCESSES){
+        printProcessSpecifics(sim, out);
+    }
+    else{
+        report_char(out, '\n');
+    }
+    printSummaryData(sim, out);
+    if ((*sim).reportFlags & REPORT_LATENCY){
+        printLatencyData(sim, out);
     }
+    if ((*sim).cores){
+        printSMPData(sim, out);
+    }
+#ifdef SCHEDULER_PROFILE
+    _profile profile = (*sim).profile;
+    PROFILE_STOP(profile, PROFILE_REPORT, start);
+    printProfile(&profile, (*sim).eventCount, out);
+#endif
+    report_text(out, "######################### END OF ");
+    report_text(out, (*algorithm).banner);
+    report_text(out, " #########################");
 }
 
-void start_process(_process *process, FILE *randomFile){
-    if ((*process).isFirstTimeRunning){
-        (*process).isFirstTimeRunning = false;
-        TOTAL_STARTED_PROCESSES++;
+int report_file_name(char* name, size_t length, const char* directory, const char* input_path,
+                     const _scheduling_algorithm* algorithm, uint32_t quantum, const char* suffix)
+{
+    const char* slash = strrchr(input_path, '/');
+    const char* input_name = slash ? slash + 1 : input_path;
+    int written;
+    if ((*algorithm).usesQuantum){
+        written = snprintf(name, length, "%s/%s.%s.q%u%s", directory, input_name, (*algorithm).key, quantum, suffix);
     }
-    (*process).status = 2;
-    (*process).nextInReadyQueue = (*process).nextInBlockedList = NULL;
-    uint32_t time, burst_time;
-    if (!(*process).CPUBurst){
-        burst_time = randomOS((*process).B, (*process).processID, randomFile);
-        time = (*process).C - (*process).currentCPUTimeRun;
-        if (time < burst_time){
-            (*process).CPUBurst = time;
-        }
-        else{
-            (*process).CPUBurst = burst_time;
-            (*process).IOBurst = burst_time * (*process).M;
-        }
+    else{
+        written = snprintf(name, length, "%s/%s.%s%s", directory, input_name, (*algorithm).key, suffix);
     }
+    return written >= 0 && (size_t) written < length ? 0 : -1;
 }
 
-void process_finished(_process* process, _process finished_processes[]){
-    _process* finished = &finished_processes[TOTAL_FINISHED_PROCESSES];
-    (*finished).A = (*process).A;
-    (*finished).B = (*process).B;
-    (*finished).C = (*process).C;
-    (*finished).M = (*process).M;
-    (*finished).processID = (*process).processID;
-    (*finished).finishingTime = (*process).finishingTime;
-    (*finished).currentCPUTimeRun = (*process).currentCPUTimeRun;
-    (*finished).currentIOBlockedTime = (*process).currentIOBlockedTime;
-    (*finished).currentWaitingTime = (*process).currentWaitingTime;
-    TOTAL_FINISHED_PROCESSES += 1;
+int run_and_report_traced(const _scheduling_algorithm* algorithm, _simulation* sim, _report_writer* out,
+                          const char* trace_name)
+{
+    _trace_writer trace;
+    FILE* file = fopen(trace_name, "wb");
+    if (!file){
+        return -1;
+    }
+    if (trace_writer_open(&trace, file, (*sim).totalCreatedProcesses, (*sim).quantum, (*algorithm).key) != 0){
+        fclose(file);
+        return -1;
+    }
+    (*sim).trace = &trace;
+    int ran = run_and_report(algorithm, sim, out);
+    (*sim).trace = NULL;
+    int closed = trace_writer_close(&trace, (*sim).currentCycle - 1);
+    if (fclose(file) != 0 || closed != 0){
+        return -1;
+    }
+    return ran == 0 ? 0 : -2;
 }
 
-void block(_process* newBlocked, _process**  oldBlocked){
-    (*newBlocked).status = 3;
-    if (!(*oldBlocked)){
-        *oldBlocked = newBlocked;
-        return;
-    }
-    else if ((**oldBlocked).IOBurst > (*newBlocked).IOBurst){
-        (*newBlocked).nextInBlockedList = *oldBlocked;
-        *oldBlocked = newBlocked;
+/* One algorithm's run and the report it produced, filled in on a worker thread */
+typedef struct ReportJob {
+    const _scheduling_algorithm* algorithm; // The algorithm to simulate
+    _simulation sim;                    // The run's own state
+    const char* reportName;             // The file the report goes to (NULL keeps it in text)
+    const char* traceName;              // The file the run is traced to (NULL when tracing is off)
+    char reportPath[BATCH_PATH_LENGTH]; // Holds reportName when the report goes to a file
+    char tracePath[BATCH_PATH_LENGTH];  // Holds traceName when the run is traced
+    bool reference;                     // Whether to run the reference engine instead of the fast one
+    char* text;                         // The report text
+    size_t length;                      // The length of the report text
+    int status;                         // 0 once the report is complete, -1 if it couldn't be written, -2 if the trace couldn't,
+                                        // -3 if the run couldn't be resumed, -4 if it couldn't be simulated
+} _report_job;
+
+static void run_report_job(void* argument)
+{
+    _report_job* job = argument;
+    _report_writer out;
+    FILE* file = NULL;
+
+    (*job).status = -1;
+    if ((*job).reportName && !(file = fopen((*job).reportName, "w"))){
         return;
     }
-    _process* current = *oldBlocked;
-    while ((*current).nextInBlockedList){
-        if ((*current).nextInBlockedList->IOBurst > (*newBlocked).IOBurst){
-            (*newBlocked).nextInBlockedList = (*current).nextInBlockedList;
-            (*current).nextInBlockedList = newBlocked;
-            return;
+    int ran = 0, traced = 0;
+    if (report_writer_init(&out, file) == 0){
+        if ((*job).traceName){
+            traced = run_and_report_traced((*job).algorithm, &(*job).sim, &out, (*job).traceName);
+            ran = traced == -2 ? -1 : 0;
+        }
+        else if ((*job).reference){
+            PROFILE_START(start);
+            ran = (*(*job).algorithm).reference(&(*job).sim);
+            PROFILE_STOP((*job).sim.profile, PROFILE_SIMULATE, start);
+            if (ran == 0){
+                write_report((*job).algorithm, &(*job).sim, &out);
+            }
         }
         else{
-            current = (*current).nextInBlockedList;
+            ran = run_and_report((*job).algorithm, &(*job).sim, &out);
+        }
+    }
+    if (file){
+        report_char(&out, '\n');
+        int closed = report_writer_close(&out);
+        (*job).status = fclose(file) == 0 && closed == 0 ? 0 : -1;
+    }
+    else{
+        (*job).text = report_writer_take(&out, &(*job).length);
+        (*job).status = (*job).text ? 0 : -1;
+    }
+    if ((*job).status == 0 && traced != 0){
+        (*job).status = -2;
+    }
+    if (ran != 0){
+        (*job).status = -4;
+        if (file){
+            remove((*job).reportName);      // It holds nothing but the newline
         }
     }
-    (*current).nextInBlockedList = newBlocked;
+    if ((*job).sim.checkpoint && (*(*job).sim.checkpoint).status == -2){
+        (*job).status = -3;
+    }
 }
 
-void FCFS(_process processes[], _process finished_processes[], FILE* randomFile){
-    _process* active = NULL, *current = NULL, *ready = NULL, *blocked = NULL;
-    while (TOTAL_FINISHED_PROCESSES < TOTAL_CREATED_PROCESSES){
-        if (blocked){
-            current = blocked;
-            TOTAL_NUMBER_OF_CYCLES_SPENT_BLOCKED += 1;
-            while (current){
-                (*current).currentIOBlockedTime += 1;
-                (*current).IOBurst -= 1;
-                if ((*current).IOBurst > 0){
-                    current = (*current).nextInBlockedList;
+#define COMMANDLINE_INPUT_LENGTH 128
+uint32_t QUANTUM = 2;
+int debug = 0;
+
+#define LOAD_INITIAL_CAPACITY 65536     // Processes allocated before the declared count has been confirmed by the input
+
+int load_processes(const char* file_name, _process_spec** process_list, uint32_t* count,
+                   char* error, size_t error_length)
+{
+    _workload_reader reader;
+    _process_spec* processes = NULL;
+    uint32_t capacity = 0;
+    int status = workload_reader_open(&reader, file_name);
+
+    // The table grows as processes are read, so a bogus count fails on the input rather than on malloc
+    while (status == 0 && reader.readCount < reader.declaredCount){
+        if (reader.readCount == capacity){
+            uint32_t grown = capacity ? capacity * 2 : LOAD_INITIAL_CAPACITY;
+            capacity = grown < capacity || grown > reader.declaredCount ? reader.declaredCount : grown;
+            _process_spec* larger = realloc(processes, (size_t) capacity * sizeof(_process_spec));
+            if (larger == NULL){
+                status = -2;
+                break;
+            }
+            processes = larger;
+        }
+        if (workload_reader_next(&reader, &processes[reader.readCount]) != 1){
+            status = -3;
+            break;
+        }
+        if(debug){
+            _process_spec* spec = &processes[reader.readCount - 1];
+            printf("A: %i, B: %i, C: %i, M: %i\n", (*spec).A, (*spec).B, (*spec).C, (*spec).M);
+        }
+    }
+    if (status == -3 && error){
+        snprintf(error, error_length, "line %u: %s", reader.line, reader.error);
+    }
+    workload_reader_close(&reader);
+    if (status != 0){
+        free(processes);
+        return status;
+    }
+
+    *process_list = processes ? processes : malloc(sizeof(_process_spec));
+    *count = reader.readCount;
+    return *process_list ? 0 : -2;
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr, "usage: %s [options] input-file|-\n"
+                    "       %s --batch <directory|manifest> [options]\n"
+                    "  -b, --batch PATH        run every input in a directory, or listed one per line in a manifest\n"
+                    "  -a, --algorithms LIST   comma separated algorithms to run, from fcfs, rr, sjf, srtf, mlfq and\n"
+                    "                          priority (default fcfs,rr,sjf)\n"
+                    "  -q, --quanta LIST       comma separated quanta; RR and MLFQ run once per quantum over the same input\n"
+                    "                          (default %u)\n"
+                    "  -o, --output-dir DIR    write one report file per algorithm to DIR instead of stdout;\n"
+                    "                          batch reports and summary.csv go here too (default %s)\n"
+                    "  -t, --trace DIR         log every state transition to DIR/<input>.<algorithm>.trace\n"
+                    "                          (trace-decode prints a log as the cycle by cycle text trace)\n"
+                    "  -j, --threads N         worker threads (default: one per online CPU)\n"
+                    "      --cpus N            simulate N CPUs, each with its own run queue; idle CPUs steal\n"
+                    "                          queued processes and the reports add per-CPU results\n"
+                    "      --reference         simulate every cycle with the reference engine instead of skipping\n"
+                    "                          between events; slow, but its reports must match (see make check)\n"
+                    "      --bench RESULTS     time loading, simulating and reporting the input instead of printing\n"
+                    "                          its reports, appending one CSV row per phase to RESULTS; each\n"
+                    "                          algorithm is also timed through the dynamically dispatched engine\n"
+                    "      --repeat N          runs per benchmarked phase, the fastest is kept (default %u)\n"
+                    "      --latency           add turnaround and waiting time percentiles (p50 to p99.9) and\n"
+                    "                          histograms to every report\n"
+                    "      --summary-only      leave every per-process line out of the reports\n"
+                    "      --ensemble N        simulate N variants of the input and print each variant's summary and\n"
+                    "                          the distribution of every summary metric across them\n"
+                    "      --vary KIND         what ensemble variants differ in: seed (variant v reads the random\n"
+                    "                          numbers from %u + v), b or m (variant v scales every B or M by\n"
+                    "                          100 + %u * v percent) (default seed)\n"
+                    "      --open              read the input as an arrival stream (a count is optional, arrival\n"
+                    "                          times must not decrease) and run one algorithm over it as it arrives,\n"
+                    "                          printing a CSV row of rolling metrics per window, then the summary\n"
+                    "      --window K          cycles per --open window (default %u)\n"
+                    "      --checkpoint FILE   snapshot the run to FILE as it goes, for --resume (one algorithm and\n"
+                    "                          quantum; default fcfs)\n"
+                    "      --checkpoint-every N  cycles between snapshots (default %u)\n"
+                    "      --resume FILE       carry on the run snapshotted in FILE, over the same input; its report\n"
+                    "                          is the one the uninterrupted run would have printed\n"
+                    "      --serve SOCKET      serve runs on a Unix domain socket until interrupted, keeping the random\n"
+                    "                          numbers and the last %u workloads parsed in memory\n"
+                    "      --connect SOCKET    run the input on the server at SOCKET and print its reports\n"
+                    "      --summaries         with --connect, ask for binary summaries and print one CSV row per run\n",
+            program, program, QUANTUM, BATCH_DEFAULT_OUTPUT_DIR, BENCH_DEFAULT_REPEATS, SEED_VALUE, ENSEMBLE_SCALE_STEP,
+            OPEN_DEFAULT_WINDOW, CHECKPOINT_DEFAULT_INTERVAL, SERVER_CACHE_ENTRIES);
+}
+
+enum { OPTION_BENCH = 256, OPTION_REPEAT, OPTION_REFERENCE, OPTION_CPUS, OPTION_ENSEMBLE, OPTION_VARY, OPTION_LATENCY,
+       OPTION_SUMMARY_ONLY, OPTION_OPEN, OPTION_WINDOW,
+       OPTION_CHECKPOINT, OPTION_CHECKPOINT_EVERY, OPTION_RESUME, OPTION_SERVE, OPTION_CONNECT, OPTION_SUMMARIES };  // Long options without a short form
+
+/**
+ * The magic starts from here
+ */
+int main(int argc, char *argv[])
+{
+    static const struct option long_options[] = {
+        { "batch", required_argument, NULL, 'b' },
+        { "quanta", required_argument, NULL, 'q' },
+        { "algorithms", required_argument, NULL, 'a' },
+        { "output-dir", required_argument, NULL, 'o' },
+        { "threads", required_argument, NULL, 'j' },
+        { "trace", required_argument, NULL, 't' },
+        { "bench", required_argument, NULL, OPTION_BENCH },
+        { "repeat", required_argument, NULL, OPTION_REPEAT },
+        { "reference", no_argument, NULL, OPTION_REFERENCE },
+        { "cpus", required_argument, NULL, OPTION_CPUS },
+        { "ensemble", required_argument, NULL, OPTION_ENSEMBLE },
+        { "vary", required_argument, NULL, OPTION_VARY },
+        { "latency", no_argument, NULL, OPTION_LATENCY },
+        { "summary-only", no_argument, NULL, OPTION_SUMMARY_ONLY },
+        { "open", no_argument, NULL, OPTION_OPEN },
+        { "window", required_argument, NULL, OPTION_WINDOW },
+        { "checkpoint", required_argument, NULL, OPTION_CHECKPOINT },
+        { "checkpoint-every", required_argument, NULL, OPTION_CHECKPOINT_EVERY },
+        { "resume", required_argument, NULL, OPTION_RESUME },
+        { "serve", required_argument, NULL, OPTION_SERVE },
+        { "connect", required_argument, NULL, OPTION_CONNECT },
+        { "summaries", no_argument, NULL, OPTION_SUMMARIES },
+        { NULL, 0, NULL, 0 }
+    };
+    _batch_config batch;
+    uint32_t thread_count = thread_pool_default_size();
+    const char* output_directory = NULL;
+    const char* trace_directory = NULL;
+    const char* bench_results = NULL;
+    uint32_t bench_repeats = BENCH_DEFAULT_REPEATS;
+    bool reference = false;
+    uint32_t ensemble_variants = 0;
+    _ensemble_vary ensemble_vary = ENSEMBLE_VARY_SEED;
+    bool open_system = false;
+    bool algorithms_given = false;
+    uint32_t window = OPEN_DEFAULT_WINDOW;
+    const char* checkpoint_path = NULL;
+    const char* resume_path = NULL;
+    uint32_t checkpoint_interval = CHECKPOINT_DEFAULT_INTERVAL;
+    bool quanta_given = false;
+    const char* serve_path = NULL;
+    const char* connect_path = NULL;
+    bool summaries = false;
+    int option;
+
+    batch_config_init(&batch);
+    while ((option = getopt_long(argc, argv, "b:q:a:o:j:t:", long_options, NULL)) != -1){
+        switch (option){
+            case 'b':
+                batch.inputPath = optarg;
+                break;
+            case 'q':
+                if (parse_quanta(optarg, &batch) != 0){
+                    fprintf(stderr, "invalid quantum list: %s\n", optarg);
+                    return -1;
                 }
-                else{
-                    blocked = (*blocked).nextInBlockedList;
-                    FCFS_ready(current, &ready);
-                    current = blocked;
+                quanta_given = true;
+                break;
+            case 'a':
+                if (parse_algorithms(optarg, &batch) != 0){
+                    fprintf(stderr, "invalid algorithm list: %s\n", optarg);
+                    return -1;
                 }
-            }
+                algorithms_given = true;
+                break;
+            case 'o':
+                batch.outputDirectory = output_directory = optarg;
+                break;
+            case 't':
+                batch.traceDirectory = trace_directory = optarg;
+                break;
+            case 'j':
+                thread_count = (uint32_t) strtoul(optarg, NULL, 10);
+                if (thread_count == 0){
+                    fprintf(stderr, "invalid thread count: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPTION_BENCH:
+                bench_results = optarg;
+                break;
+            case OPTION_REPEAT:
+                bench_repeats = (uint32_t) strtoul(optarg, NULL, 10);
+                if (bench_repeats == 0){
+                    fprintf(stderr, "invalid repeat count: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPTION_REFERENCE:
+                reference = true;
+                break;
+            case OPTION_CPUS:
+                batch.cpuCount = (uint32_t) strtoul(optarg, NULL, 10);
+                if (batch.cpuCount == 0){
+                    fprintf(stderr, "invalid CPU count: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPTION_ENSEMBLE:
+                ensemble_variants = (uint32_t) strtoul(optarg, NULL, 10);
+                if (ensemble_variants == 0 || ensemble_variants > ENSEMBLE_MAX_VARIANTS){
+                    fprintf(stderr, "invalid variant count: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPTION_VARY:
+                if (parse_ensemble_vary(optarg, &ensemble_vary) != 0){
+                    fprintf(stderr, "invalid variation: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPTION_LATENCY:
+                batch.reportFlags |= REPORT_LATENCY;
+                break;
+            case OPTION_SUMMARY_ONLY:
+                batch.reportFlags &= ~REPORT_PROCESSES;
+                break;
+            case OPTION_OPEN:
+                open_system = true;
+                break;
+            case OPTION_WINDOW:
+                window = (uint32_t) strtoul(optarg, NULL, 10);
+                if (window == 0){
+                    fprintf(stderr, "invalid window: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPTION_CHECKPOINT:
+                checkpoint_path = optarg;
+                break;
+            case OPTION_CHECKPOINT_EVERY:
+                checkpoint_interval = (uint32_t) strtoul(optarg, NULL, 10);
+                if (checkpoint_interval == 0){
+                    fprintf(stderr, "invalid checkpoint interval: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPTION_RESUME:
+                resume_path = optarg;
+                break;
+            case OPTION_SERVE:
+                serve_path = optarg;
+                break;
+            case OPTION_CONNECT:
+                connect_path = optarg;
+                break;
+            case OPTION_SUMMARIES:
+                summaries = true;
+                break;
+            default:
+                usage(argv[0]);
+                return -1;
         }
-        for (int i = 0; i < TOTAL_CREATED_PROCESSES; i++){
-            if (processes[i].A == CURRENT_CYCLE){
-                FCFS_ready(&processes[i], &ready);
-            }
+    }
+
+    // Write code for your shiny scheduler
+    if(debug){
+        printf("argc = %i, argv[0] = %s\n", argc, argv[0]);
+        printf("argc = %i, argv[1] = %s\n", argc, argv[1]);
+    }
+
+    if (reference && (batch.inputPath || trace_directory || bench_results || batch.cpuCount)){
+        fprintf(stderr, "--reference only applies to a single untraced run on one CPU\n");
+        return -1;
+    }
+
+    if (ensemble_variants && (batch.inputPath || trace_directory || output_directory || bench_results || reference)){
+        fprintf(stderr, "--ensemble only applies to a single input reported on stdout\n");
+        return -1;
+    }
+
+    if (open_system && (batch.inputPath || trace_directory || output_directory || bench_results || reference
+                        || batch.cpuCount || ensemble_variants)){
+        fprintf(stderr, "--open only applies to a single input reported on stdout on one CPU\n");
+        return -1;
+    }
+
+    if (open_system && ((algorithms_given && batch.algorithmCount != 1) || batch.quantumCount != 1)){
+        fprintf(stderr, "--open runs one algorithm with one quantum\n");
+        return -1;
+    }
+
+    if ((serve_path || connect_path) && (batch.inputPath || trace_directory || output_directory || bench_results
+                                         || reference || batch.cpuCount || ensemble_variants || open_system
+                                         || checkpoint_path || resume_path || (serve_path && connect_path))){
+        fprintf(stderr, "--serve and --connect only run single inputs reported on stdout on one CPU\n");
+        return -1;
+    }
+
+    if (summaries && !connect_path){
+        fprintf(stderr, "--summaries only applies to --connect\n");
+        return -1;
+    }
+
+    if (serve_path){
+        return run_server(serve_path, thread_count);
+    }
+
+    if (connect_path && optind < argc){
+        return run_client(connect_path, argv[optind], &batch, summaries);
+    }
+
+    if ((checkpoint_path || resume_path) && (batch.inputPath || trace_directory || bench_results || reference
+                                             || batch.cpuCount || ensemble_variants || open_system)){
+        fprintf(stderr, "--checkpoint and --resume only apply to a single untraced run on one CPU\n");
+        return -1;
+    }
+
+    if (resume_path){
+        _checkpoint_header header;
+        int read = checkpoint_read_header(resume_path, &header);
+        if (read != 0){
+            fprintf(stderr, read == -1 ? "can't read %s\n" : "%s is not a snapshot this build can resume\n", resume_path);
+            return -1;
         }
-        if(active){
-            (*active).CPUBurst -= 1;
-            (*active).currentCPUTimeRun += 1;
-            if ((*active).currentCPUTimeRun == (*active).C){
-                (*active).finishingTime = CURRENT_CYCLE;
-                (*active).status = 4;
-                process_finished(active, finished_processes);
-                active = NULL;
-            }
-            else if ((*active).CPUBurst == 0){
-                block(active, &blocked);
-                active = NULL;
-            }
+        if (algorithms_given || quanta_given){
+            fprintf(stderr, "--resume runs the algorithm and quantum the snapshot was taken with\n");
+            return -1;
         }
-        if (ready && !active){
-            active = ready;
-            ready = (*ready).nextInReadyQueue;
-            start_process(active, randomFile);
+        if (parse_algorithms(header.algorithmKey, &batch) != 0 || batch.algorithmCount != 1){
+            fprintf(stderr, "%s names an unknown algorithm\n", resume_path);
+            return -1;
         }
-        current = ready;
-        while (current){
-            (*current).currentWaitingTime += 1;
-            current = (*current).nextInReadyQueue;
+        batch.quanta[0] = header.quantum;
+        batch.quantumCount = 1;
+    }
+    else if (checkpoint_path){
+        if ((algorithms_given && batch.algorithmCount != 1) || batch.quantumCount != 1){
+            fprintf(stderr, "--checkpoint runs one algorithm with one quantum\n");
+            return -1;
         }
-        CURRENT_CYCLE += 1;
+        batch.algorithms[0] = algorithms_given ? batch.algorithms[0] : &ALGORITHMS[0];
+        batch.algorithmCount = 1;
     }
-}
 
-void FCFS_ready(_process* newReady, _process** oldReady){
-    (*newReady).status = 1;
-    if (!(*oldReady)){
-        *oldReady = newReady;
-        return;
+    if (batch.inputPath){
+        batch.threadCount = thread_count;
+        return run_batch(&batch);
     }
-    else{
-        _process* current = *oldReady;
-        while ((*current).nextInReadyQueue){
-            current = (*current).nextInReadyQueue;
-        }
-        (*current).nextInReadyQueue = newReady;
+
+    if (bench_results && optind < argc){
+        return run_bench(argv[optind], bench_results, bench_repeats, batch.algorithms, batch.algorithmCount);
     }
-}
 
-void RR(_process processes[], _process finished_processes[], FILE* randomFile){
-    _process* active = NULL, *current = NULL, *ready = NULL, *blocked = NULL, *temp = NULL;
-    while (TOTAL_FINISHED_PROCESSES < TOTAL_CREATED_PROCESSES){
-        if (blocked){
-            TOTAL_NUMBER_OF_CYCLES_SPENT_BLOCKED += 1;
-            current = blocked;
-            while (current){
-                (*current).currentIOBlockedTime += 1;
-                (*current).IOBurst -= 1;
-                if ((*current).IOBurst > 0){
-                    current = (*current).nextInBlockedList;
-                }
-                else{
-                    if (ready){
-                        temp = ready;
-                        while((*temp).nextInReadyQueue){
-                            temp = (*temp).nextInReadyQueue;
-                        }
-                        (*temp).nextInReadyQueue = current;
+    if (ensemble_variants && optind < argc){
+        batch.threadCount = thread_count;
+        return run_ensemble(argv[optind], &batch, ensemble_variants, ensemble_vary);
+    }
+
+    if (open_system && optind < argc){
+        const _scheduling_algorithm* algorithm = algorithms_given ? batch.algorithms[0] : &ALGORITHMS[0];
+        return run_open_system(argv[optind], algorithm, (*algorithm).usesQuantum ? batch.quanta[0] : QUANTUM, window,
+                               batch.reportFlags);
+    }
+
+    if(optind < argc)
+    {
+        const char* input_file = argv[optind];
+        _process_spec* process_list;
+        uint32_t total_num_of_process;
+        char load_error[128];
+        int loaded = load_processes(input_file, &process_list, &total_num_of_process, load_error, sizeof(load_error));
+        if (loaded == -1){
+            printf("%s not found\n", input_file);
+            return -1;
+        }
+        else if (loaded == -3){
+            printf("%s: %s\n", input_file, load_error);
+            return -1;
+        }
+        else if (loaded != 0){
+            printf("Out of memory loading %s\n", input_file);
+            return -1;
+        }
+        _random_source randomSource;
+        if (random_source_load(&randomSource, RANDOM_NUMBER_FILE_NAME) != 0){
+            printf("%s not found\n", RANDOM_NUMBER_FILE_NAME);
+            return -1;
+        }
+
+        _arrival_index arrivals;
+        if (build_arrival_index(process_list, total_num_of_process, &arrivals) != 0){
+            printf("Out of memory indexing %i processes\n", total_num_of_process);
+            return -1;
+        }
+
+        // Each algorithm runs once, or once per quantum if it uses one, on its own process state, in parallel ----------
+
+        if (output_directory && mkdir(output_directory, 0777) != 0 && errno != EEXIST){
+            printf("can't create %s\n", output_directory);
+            return -1;
+        }
+        if (trace_directory && mkdir(trace_directory, 0777) != 0 && errno != EEXIST){
+            printf("can't create %s\n", trace_directory);
+            return -1;
+        }
+
+        _checkpoint checkpoint;
+        uint32_t job_count = 0;
+        _report_job* jobs = calloc((size_t) batch.algorithmCount * batch.quantumCount, sizeof(_report_job));
+        if (!jobs){
+            printf("Out of memory simulating %i processes\n", total_num_of_process);
+            return -1;
+        }
+        for (uint32_t i = 0; i < batch.algorithmCount; i++){
+            const _scheduling_algorithm* algorithm = batch.algorithms[i];
+            if (reference && !(*algorithm).reference){
+                printf("%s has no reference engine\n", (*algorithm).name);
+                return -1;
+            }
+            for (uint32_t k = 0; k < ((*algorithm).usesQuantum ? batch.quantumCount : 1); k++){
+                _report_job* job = &jobs[job_count++];
+                uint32_t quantum = (*algorithm).usesQuantum ? batch.quanta[k] : QUANTUM;
+                (*job).algorithm = algorithm;
+                (*job).reference = reference;
+                // With an output directory each run's report goes straight to its own file
+                if (output_directory){
+                    if (report_file_name((*job).reportPath, sizeof((*job).reportPath), output_directory, input_file,
+                                         algorithm, quantum, ".txt") != 0){
+                        printf("report name too long for %s\n", input_file);
+                        return -1;
                     }
-                    else{
-                        ready = current;
+                    (*job).reportName = (*job).reportPath;
+                }
+                if (trace_directory){
+                    if (report_file_name((*job).tracePath, sizeof((*job).tracePath), trace_directory, input_file,
+                                         algorithm, quantum, TRACE_FILE_SUFFIX) != 0){
+                        printf("trace name too long for %s\n", input_file);
+                        return -1;
                     }
-                    blocked = (*blocked).nextInBlockedList;
-                    current = blocked;
+                    (*job).traceName = (*job).tracePath;
                 }
-            }
-        }
-        if (TOTAL_STARTED_PROCESSES < TOTAL_CREATED_PROCESSES){
-            for (int i = 0; i < TOTAL_CREATED_PROCESSES; i++){
-                if (processes[i].A == CURRENT_CYCLE){
-                    RR_ready(&processes[i], &ready);
+                if (simulation_init(&(*job).sim, process_list, total_num_of_process, &arrivals, &randomSource, quantum,
+                                    batch.cpuCount) != 0){
+                    printf("Out of memory simulating %i processes\n", total_num_of_process);
+                    return -1;
+                }
+                (*job).sim.reportFlags = batch.reportFlags;
+                // Only a single run can be checkpointed, so there is one checkpoint for it
+                if (checkpoint_path || resume_path){
+                    checkpoint_init(&checkpoint, checkpoint_path, resume_path, checkpoint_interval, (*algorithm).key,
+                                    process_list, total_num_of_process);
+                    (*job).sim.checkpoint = &checkpoint;
                 }
             }
         }
-        if(active){
-            (*active).CPUBurst -= 1;
-            (*active).quantum -= 1;
-            (*active).currentCPUTimeRun += 1;
-            if ((*active).currentCPUTimeRun == (*active).C){
-                (*active).finishingTime = CURRENT_CYCLE;
-                (*active).status = 4;
-                process_finished(active, finished_processes);
-                active = NULL;
-            }
-            else if ((*active).CPUBurst == 0){
-                (*active).quantum = 2;
-                block(active, &blocked);
-                active = NULL;
+
+        _thread_pool* pool = thread_pool_create(thread_count < job_count ? thread_count : job_count);
+        for (uint32_t i = 0; i < job_count; i++){
+            if (!pool || thread_pool_submit(pool, run_report_job, &jobs[i]) != 0){
+                run_report_job(&jobs[i]);
             }
-            else if ((*active).quantum == 0){
-                if(ready){
-                    current = ready;
-                    while((*current).nextInReadyQueue){
-                        current = (*current).nextInReadyQueue;
-                    }
-                    (*current).nextInReadyQueue = active;
-                    (*active).quantum = 2;
-                    (*active).status = 1;
-                    active = NULL;
+        }
+        thread_pool_destroy(pool);
+
+        // Reports are emitted in the order the algorithms (and quanta) were listed, regardless of which finished first
+        for (uint32_t i = 0; i < job_count; i++){
+            if (jobs[i].status != 0){
+                if (jobs[i].status == -2){
+                    printf("can't write %s\n", jobs[i].traceName);
+                }
+                else if (jobs[i].status == -3){
+                    printf("%s\n", (*jobs[i].sim.checkpoint).error);
                 }
+                else if (jobs[i].status == -4){
+                    printf("Out of memory simulating %s\n", (*jobs[i].algorithm).name);
+                }
+                else if (jobs[i].reportName){
+                    printf("can't write %s\n", jobs[i].reportName);
+                }
+                else{
+                    printf("Out of memory reporting %s\n", (*jobs[i].algorithm).name);
+                }
+                return -1;
+            }
+            if (!jobs[i].reportName){
+                fwrite(jobs[i].text, 1, jobs[i].length, stdout);
             }
+            free(jobs[i].text);
+            simulation_free(&jobs[i].sim);
         }
-        if (ready && !active){
-            active = ready;
-            ready = (*ready).nextInReadyQueue;
-            start_process(active, randomFile);
+        free(jobs);
+        if (!output_directory){
+            printf("\n");
         }
-        current = ready;
-        while (current){
-            (*current).currentWaitingTime += 1;
-            current = (*current).nextInReadyQueue;
+
+        random_source_free(&randomSource);
+        free((void*) arrivals.order);
+        free(process_list);
+        if ((checkpoint_path || resume_path) && checkpoint.status != 0){
+            printf("%s\n", checkpoint.error);
+            return -1;
         }
-        CURRENT_CYCLE += 1;
     }
+    return 0;
 }
 
-void RR_ready(_process *newReady, _process **oldReady){
-    (*newReady).status = 1;
-    if (!(*oldReady)) {
-        *oldReady = newReady;
-        return;
-    }
-    else if ((**oldReady).A > (*newReady).A) {
-        (*newReady).nextInReadyQueue = *oldReady;
-        *oldReady = newReady;
-        return;
+/**
+ * Logs process entering its current status with burst cycles to go, when the run is traced
+ */
+static inline void trace_status(_simulation* sim, uint32_t process, uint32_t burst){
+    if ((*sim).trace){
+        trace_transition((*sim).trace, (*sim).currentCycle, process, (*sim).states[process].status, burst);
     }
-    else if ((((**oldReady).processID) > (*newReady).processID) && ((*newReady).A == (**oldReady).A)){
-        (*newReady).nextInReadyQueue = *oldReady;
-        *oldReady = newReady;
-        return;
+}
+
+int simulation_init(_simulation* sim, const _process_spec input[], uint32_t count,
+                    const _arrival_index* arrivals, const _random_source* randomSource, uint32_t quantum,
+                    uint32_t cpu_count){
+    memset(sim, 0, sizeof(*sim));
+    size_t states_size = (size_t) count * sizeof(_process_state);
+    size_t stats_size = (size_t) count * sizeof(_process_stats);
+    size_t order_size = (size_t) count * sizeof(uint32_t);
+    size_t cores_size = (size_t) cpu_count * sizeof(_core_stats);
+    if (arena_init(&(*sim).arena, arena_footprint(states_size) + arena_footprint(stats_size)
+                                  + arena_footprint(order_size) + arena_footprint(cores_size)
+                                  + 2 * arena_footprint(sizeof(_histogram))) != 0){
+        return -1;
     }
-    else{
-        _process *current = *oldReady;
-        while ((*current).nextInReadyQueue) {
-            if ((*current).nextInReadyQueue->A > (*newReady).A) {
-                (*newReady).nextInReadyQueue = (*current).nextInReadyQueue;
-                (*current).nextInReadyQueue = newReady;
-                return;
-            }
-            else if ((((*current).nextInReadyQueue->processID > (*newReady).processID) && ((*newReady).A == (*current).nextInReadyQueue->A))){
-                (*newReady).nextInReadyQueue = (*current).nextInReadyQueue;
-                (*current).nextInReadyQueue = newReady;
-                return;
-            }
-            current = (*current).nextInReadyQueue;
-        }
-        (*current).nextInReadyQueue = newReady;
+    (*sim).states = arena_alloc(&(*sim).arena, states_size);
+    (*sim).stats = arena_alloc(&(*sim).arena, stats_size);
+    (*sim).completionOrder = arena_alloc(&(*sim).arena, order_size);
+    (*sim).cores = cpu_count ? arena_alloc(&(*sim).arena, cores_size) : NULL;
+    (*sim).turnaroundHistogram = arena_alloc(&(*sim).arena, sizeof(_histogram));
+    (*sim).waitingHistogram = arena_alloc(&(*sim).arena, sizeof(_histogram));
+    (*sim).reportFlags = REPORT_DEFAULT;
+    (*sim).cpuCount = cpu_count;
+    (*sim).specs = input;
+    (*sim).arrivals = *arrivals;
+    (*sim).arrivals.cursor = 0;
+    (*sim).randomSource = randomSource;
+    (*sim).totalCreatedProcesses = count;
+    (*sim).quantum = quantum;
+    initialize_processes(sim);
+    return 0;
+}
+
+void simulation_free(_simulation* sim){
+    arena_free(&(*sim).arena);
+    (*sim).states = NULL;
+    (*sim).stats = NULL;
+    (*sim).completionOrder = NULL;
+    (*sim).cores = NULL;
+    (*sim).turnaroundHistogram = NULL;
+    (*sim).waitingHistogram = NULL;
+}
+
+void initialize_processes(_simulation* sim){
+    for (uint32_t i = 0; i < (*sim).totalCreatedProcesses; i++){
+        initialize_process(sim, i);
     }
+    histogram_init((*sim).turnaroundHistogram);
+    histogram_init((*sim).waitingHistogram);
 }
 
-void SJF(_process processes[], _process finished_processes[], FILE* randomFile){
-    _process* active = NULL, *current = NULL, *ready = NULL, *blocked = NULL;
-    while (TOTAL_FINISHED_PROCESSES < TOTAL_CREATED_PROCESSES){
-        if (blocked){
-            current = blocked;
-            TOTAL_NUMBER_OF_CYCLES_SPENT_BLOCKED += 1;
-            while (current){
-                (*current).currentIOBlockedTime += 1;
-                (*current).IOBurst -= 1;
-                if ((*current).IOBurst > 0){
-                    current = (*current).nextInBlockedList;
-                }
-                else{
-                    blocked = (*blocked).nextInBlockedList;
-                    SJF_ready(current, &ready);
-                    current = blocked;
-                }
-            }
+void initialize_process(_simulation* sim, uint32_t process){
+    _process_state* state = &(*sim).states[process];
+    _process_stats* stats = &(*sim).stats[process];
+    (*state).status = 0;
+    (*state).currentCPUTimeRun = 0;
+    (*state).readySinceCycle = 0;
+    (*state).IOBurst = 0;
+    (*state).CPUBurst = 0;
+    (*state).quantum = (*sim).quantum;
+    (*state).isFirstTimeRunning = true;
+    (*state).level = 0;
+    (*stats).finishingTime = -1;
+    (*stats).currentIOBlockedTime = 0;
+    (*stats).currentWaitingTime = 0;
+}
+
+void start_process(_simulation* sim, uint32_t process){
+    const _process_spec* spec = &(*sim).specs[process];
+    _process_state* state = &(*sim).states[process];
+    (*sim).stats[process].currentWaitingTime += (*sim).currentCycle - (*state).readySinceCycle;
+    PROFILE_COUNT(sim, dispatches, 1);
+    if ((*state).isFirstTimeRunning){
+        (*state).isFirstTimeRunning = false;
+        (*sim).totalStartedProcesses++;
+    }
+    (*state).status = 2;
+    uint32_t time, burst_time;
+    if (!(*state).CPUBurst){
+        burst_time = randomOS((*spec).B, (*sim).randomIndex ? (*sim).randomIndex[process] : process,
+                              (*sim).randomSource);
+        PROFILE_COUNT(sim, randomLookups, 1);
+        time = (*spec).C - (*state).currentCPUTimeRun;
+        if (time < burst_time){
+            (*state).CPUBurst = time;
         }
-        for (int i = 0; i < TOTAL_CREATED_PROCESSES; i++){
-            if (processes[i].A == CURRENT_CYCLE){
-                SJF_ready(&processes[i], &ready);
-            }
+        else{
+            (*state).CPUBurst = burst_time;
+            (*state).IOBurst = burst_time * (*spec).M;
         }
-        if(active){
-            (*active).CPUBurst -= 1;
-            (*active).currentCPUTimeRun += 1;
-            if ((*active).currentCPUTimeRun == (*active).C){
-                (*active).finishingTime = CURRENT_CYCLE;
-                (*active).status = 4;
-                process_finished(active, finished_processes);
-                active = NULL;
-            }
-            else if ((*active).CPUBurst == 0){
-                block(active, &blocked);
-                active = NULL;
-            }
+    }
+    trace_status(sim, process, (*state).CPUBurst);
+}
+
+/**
+ * Appends process, whose finishingTime is set, to the completion log and records its turnaround and waiting
+ * times in the run's histograms. Its results stay in the run's tables, so nothing is copied.
+ */
+void process_finished(_simulation* sim, uint32_t process){
+    const _process_stats* stats = &(*sim).stats[process];
+    (*sim).completionOrder[(*sim).totalFinishedProcesses] = process;
+    (*sim).totalFinishedProcesses += 1;
+    histogram_record((*sim).turnaroundHistogram, (uint32_t) (*stats).finishingTime - (*sim).specs[process].A);
+    histogram_record((*sim).waitingHistogram, (*stats).currentWaitingTime);
+    trace_status(sim, process, 0);
+}
+
+/**
+ * Orders two arrival keys, (A << 32 | process index)
+ */
+static int compare_arrivals(const void* left, const void* right){
+    uint64_t a = *(const uint64_t*) left, b = *(const uint64_t*) right;
+    return a < b ? -1 : (a > b);
+}
+
+/**
+ * Builds the arrival index for the count processes in process_list.
+ * Process IDs are the input positions, so sorting on (A, index) orders ties by process ID.
+ * Returns 0 on success, -1 if the index can't be allocated.
+ */
+int build_arrival_index(const _process_spec process_list[], uint32_t count, _arrival_index* arrivals){
+    uint64_t* keys = malloc((count ? count : 1) * sizeof(uint64_t));
+    (*arrivals).count = count;
+    (*arrivals).cursor = 0;
+    uint32_t* order = malloc((count ? count : 1) * sizeof(uint32_t));
+    (*arrivals).order = order;
+    if (!keys || !order){
+        free(keys);
+        free(order);
+        return -1;
+    }
+    for (uint32_t i = 0; i < count; i++){
+        keys[i] = ((uint64_t) process_list[i].A << 32) | i;
+    }
+    qsort(keys, count, sizeof(uint64_t), compare_arrivals);
+    for (uint32_t i = 0; i < count; i++){
+        order[i] = (uint32_t) keys[i];
+    }
+    free(keys);
+    return 0;
+}
+
+/**
+ * Returns the next process arriving on (*sim).currentCycle and moves the cursor past it,
+ * or NO_PROCESS once every process arriving this cycle has been handed out.
+ */
+uint32_t next_arrival(_simulation* sim){
+    _arrival_index* arrivals = &(*sim).arrivals;
+    PROFILE_COUNT(sim, arrivalChecks, 1);
+    if ((*arrivals).cursor < (*arrivals).count
+            && (*sim).specs[(*arrivals).order[(*arrivals).cursor]].A <= (*sim).currentCycle){
+        return (*arrivals).order[(*arrivals).cursor++];
+    }
+    return NO_PROCESS;
+}
+
+/**
+ * Blocks newBlocked for its I/O burst. The cycles the blocked set is non-empty are
+ * accumulated per busy period rather than counted cycle by cycle.
+ */
+void block(_simulation* sim, uint32_t newBlocked, _blocked_set* blocked){
+    _process_state* state = &(*sim).states[newBlocked];
+    (*state).status = 3;
+    if (!(*blocked).length){
+        (*sim).blockedSinceCycle = (*sim).currentCycle;
+    }
+    blocked_set_push(blocked, (*sim).currentCycle + (*state).IOBurst, newBlocked);
+    PROFILE_COUNT(sim, blockedInserts, 1);
+    trace_status(sim, newBlocked, (*state).IOBurst);
+}
+
+/**
+ * Returns the next process whose I/O completes on (*sim).currentCycle, crediting it with the
+ * cycles between blocking and waking, or NO_PROCESS once every process waking this cycle has been handed out.
+ */
+uint32_t next_unblocked(_simulation* sim, _blocked_set* blocked){
+    PROFILE_COUNT(sim, unblockChecks, 1);
+    if (!(*blocked).length || (*blocked).entries[0].wakeCycle > (*sim).currentCycle){
+        return NO_PROCESS;
+    }
+    uint32_t woken = blocked_set_pop(blocked);
+    (*sim).stats[woken].currentIOBlockedTime += (*sim).states[woken].IOBurst;
+    if (!(*blocked).length){
+        (*sim).totalCyclesSpentBlocked += (*sim).currentCycle - (*sim).blockedSinceCycle;
+    }
+    return woken;
+}
+
+// The engine ----------
+
+#define ENGINE_INLINE static inline __attribute__((always_inline)) // Compiled into each caller, never called
+
+/**
+ * Jumps (*sim).currentCycle forward to the next cycle in which something can happen: an arrival,
+ * the first blocked process finishing its I/O, the active process finishing its burst or
+ * the policy's next decision (such as a quantum running out). Every cycle in between would only
+ * have ticked the same counters, so they are applied in bulk for the skipped interval.
+ * Must be called right after (*sim).currentCycle has been advanced past the cycle just simulated.
+ */
+ENGINE_INLINE void skip_to_next_event(_simulation* sim, uint32_t active, _blocked_set* blocked,
+                                      const _scheduling_policy* policy, const _policy_queue* ready){
+    _arrival_index* arrivals = &(*sim).arrivals;
+    _process_state* state = active != NO_PROCESS ? &(*sim).states[active] : NULL;
+    uint32_t last_cycle = (*sim).currentCycle - 1;
+    uint32_t next_cycle = UINT32_MAX;
+
+    if ((*arrivals).cursor < (*arrivals).count){
+        next_cycle = (*sim).specs[(*arrivals).order[(*arrivals).cursor]].A;
+    }
+    if ((*blocked).length && (*blocked).entries[0].wakeCycle < next_cycle){
+        next_cycle = (*blocked).entries[0].wakeCycle;
+    }
+    if (state){
+        if (last_cycle + (*state).CPUBurst < next_cycle){
+            next_cycle = last_cycle + (*state).CPUBurst;
         }
-        if (ready && !active){
-            active = ready;
-            ready = (*ready).nextInReadyQueue;
-            start_process(active, randomFile);
+        if ((*policy).nextDecision){
+            uint32_t decision = (*policy).nextDecision(sim, ready, active);
+            next_cycle = decision < next_cycle ? decision : next_cycle;
         }
-        current = ready;
-        while (current){
-            (*current).currentWaitingTime += 1;
-            current = (*current).nextInReadyQueue;
+    }
+    if (next_cycle <= (*sim).currentCycle || next_cycle == UINT32_MAX){
+        return;
+    }
+
+    uint32_t skipped = next_cycle - (*sim).currentCycle;
+    PROFILE_COUNT(sim, skips, 1);
+    PROFILE_COUNT(sim, skippedCycles, skipped);
+    if (state){
+        (*state).CPUBurst -= skipped;
+        (*state).currentCPUTimeRun += skipped;
+        if ((*policy).timeSliced){
+            (*state).quantum -= skipped;
         }
-        CURRENT_CYCLE += 1;
     }
+    (*sim).currentCycle = next_cycle;
 }
 
-void SJF_ready(_process *newReady, _process **oldReady){
-    (*newReady).status = 1;
-    if (!(*oldReady)) {
-        *oldReady = newReady;
-        return;
-    }
-    else if(((**oldReady).C - (**oldReady).currentCPUTimeRun) > ((*newReady).C - (*newReady).currentCPUTimeRun)){
-        (*newReady).nextInReadyQueue = *oldReady;
-        *oldReady = newReady;
-        return;
+/**
+ * make_ready, for the engine
+ */
+ENGINE_INLINE void queue_ready(_simulation* sim, const _scheduling_policy* policy, _policy_queue* queue,
+                              uint32_t process){
+    _process_state* state = &(*sim).states[process];
+    (*state).status = 1;
+    (*state).readySinceCycle = (*sim).currentCycle;
+    (*queue).length++;
+    (*policy).ready(sim, queue, process);
+    PROFILE_COUNT(sim, readyInserts, 1);
+    trace_status(sim, process, (*state).CPUBurst);
+}
+
+/**
+ * The cycle loop shared by every policy: I/O completions and arrivals become ready, the running
+ * process ticks and finishes, blocks or is preempted, and an idle CPU picks the next process.
+ * Inlined into every caller, so a caller passing a constant policy gets a loop of its own.
+ * With a checkpoint the run starts from its snapshot, if it has one, and is snapshotted as it goes.
+ * Returns 0 once the run is complete, -1 if its queues can't be allocated or its snapshot can't be resumed.
+ */
+ENGINE_INLINE int run_engine(_simulation* sim, const _scheduling_policy* policy){
+    _process_state* states = (*sim).states;
+    uint32_t active = NO_PROCESS, current;
+    _blocked_set blocked;
+    _policy_queue ready;
+    if (policy_queue_init(&ready, policy, (*sim).totalCreatedProcesses) != 0){
+        return -1;
     }
-    else if (((**oldReady).A > (*newReady).A) && (((**oldReady).C - (**oldReady).currentCPUTimeRun) == ((*newReady).C - (*newReady).currentCPUTimeRun))) {
-        (*newReady).nextInReadyQueue = *oldReady;
-        *oldReady = newReady;
-        return;
+    if (blocked_set_init(&blocked, (*sim).totalCreatedProcesses) != 0){
+        policy_queue_free(&ready);
+        return -1;
     }
-    else if ((((**oldReady).processID) > (*newReady).processID) && ((*newReady).A == (**oldReady).A) && (((**oldReady).C - (**oldReady).currentCPUTimeRun) == ((*newReady).C - (*newReady).currentCPUTimeRun))){
-        (*newReady).nextInReadyQueue = *oldReady;
-        *oldReady = newReady;
-        return;
+    (*sim).arrivals.cursor = 0;
+    if ((*sim).checkpoint && checkpoint_resume((*sim).checkpoint, sim, policy, &ready, &blocked, &active) != 0){
+        policy_queue_free(&ready);
+        blocked_set_free(&blocked);
+        return -1;
     }
-    else{
-        _process *current = *oldReady;
-        while ((*current).nextInReadyQueue) {
-            if (((*current).C - (*current).currentCPUTimeRun) > ((*newReady).C - (*newReady).currentCPUTimeRun)) {
-                (*newReady).nextInReadyQueue = (*current).nextInReadyQueue;
-                (*current).nextInReadyQueue = newReady;
-                return;
+    uint32_t snapshot_cycle = (*sim).checkpoint ? (*(*sim).checkpoint).nextCycle : UINT32_MAX;
+    while ((*sim).totalFinishedProcesses < (*sim).totalCreatedProcesses){
+        while ((current = next_unblocked(sim, &blocked)) != NO_PROCESS){
+            queue_ready(sim, policy, &ready, current);
+        }
+        while ((current = next_arrival(sim)) != NO_PROCESS){
+            queue_ready(sim, policy, &ready, current);     // Arrivals come out of the index already ordered by (A, processID)
+        }
+        if(active != NO_PROCESS){
+            _process_state* state = &states[active];
+            (*state).CPUBurst -= 1;
+            (*state).currentCPUTimeRun += 1;
+            if ((*policy).timeSliced){
+                (*state).quantum -= 1;
+            }
+            if ((*state).currentCPUTimeRun == (*sim).specs[active].C){
+                (*sim).stats[active].finishingTime = (*sim).currentCycle;
+                (*state).status = 4;
+                process_finished(sim, active);
+                active = NO_PROCESS;
             }
-            else if (((*current).A > (*newReady).A) && (((*current).C - (*current).currentCPUTimeRun) == ((*newReady).C - (*newReady).currentCPUTimeRun))){
-                (*newReady).nextInReadyQueue = (*current).nextInReadyQueue;
-                (*current).nextInReadyQueue = newReady;
-                return;
+            else if ((*state).CPUBurst == 0){
+                block(sim, active, &blocked);
+                active = NO_PROCESS;
             }
-            else if ((((*current).processID) > (*newReady).processID) && ((*newReady).A == (*current).A) && (((*current).C - (*current).currentCPUTimeRun) == ((*newReady).C - (*newReady).currentCPUTimeRun))){
-                (*newReady).nextInReadyQueue = (*current).nextInReadyQueue;
-                (*current).nextInReadyQueue = newReady;
-                return;
+            else if ((*policy).preempt && (*policy).preempt(sim, &ready, active)){
+                PROFILE_COUNT(sim, preemptions, 1);
+                queue_ready(sim, policy, &ready, active);
+                active = NO_PROCESS;
             }
-            current = (*current).nextInReadyQueue;
         }
-        (*current).nextInReadyQueue = newReady;
+        if (ready.length && active == NO_PROCESS){
+            active = pick_next(sim, policy, &ready);
+            start_process(sim, active);
+        }
+        (*sim).currentCycle += 1;
+        (*sim).eventCount += 1;
+        skip_to_next_event(sim, active, &blocked, policy, &ready);
+        if ((*sim).currentCycle >= snapshot_cycle){
+            checkpoint_save((*sim).checkpoint, sim, policy, &ready, &blocked, active);
+            snapshot_cycle = (*(*sim).checkpoint).nextCycle;
+        }
     }
-}
\ No newline at end of file
+    policy_queue_free(&ready);
+    blocked_set_free(&blocked);
+    return 0;
+}
+
+void make_ready(_simulation* sim, const _scheduling_policy* policy, _policy_queue* queue, uint32_t process){
+    queue_ready(sim, policy, queue, process);
+}
+
+/**
+ * The engine with policy's hooks called through their pointers, the way smp.c and the
+ * benchmark's dynamic phase run it. FCFS through PRIORITY below each get a specialised copy.
+ */
+__attribute__((noinline)) int simulate(_simulation* sim, const _scheduling_policy* policy){
+    return run_engine(sim, policy);
+}
+
+int FCFS(_simulation* sim){
+    static const _scheduling_policy policy = FCFS_POLICY_HOOKS;
+    return run_engine(sim, &policy);
+}
+
+int RR(_simulation* sim){
+    static const _scheduling_policy policy = RR_POLICY_HOOKS;
+    return run_engine(sim, &policy);
+}
+
+int SJF(_simulation* sim){
+    static const _scheduling_policy policy = SJF_POLICY_HOOKS;
+    return run_engine(sim, &policy);
+}
+
+int SRTF(_simulation* sim){
+    static const _scheduling_policy policy = SRTF_POLICY_HOOKS;
+    return run_engine(sim, &policy);
+}
+
+int MLFQ(_simulation* sim){
+    static const _scheduling_policy policy = MLFQ_POLICY_HOOKS;
+    return run_engine(sim, &policy);
+}
+
+int PRIORITY(_simulation* sim){
+    static const _scheduling_policy policy = PRIORITY_POLICY_HOOKS;
+    return run_engine(sim, &policy);
+}
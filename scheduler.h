@@ -0,0 +1,209 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "random_source.h"
+#include "ready_queue.h"
+#include "blocked_set.h"
+#include "report_writer.h"
+#include "trace.h"
+#include "profile.h"
+#include "histogram.h"
+
+typedef enum {false, true} bool;        // Allows boolean types in C
+
+#define NO_PROCESS UINT32_MAX            // Stands in for "no process" wherever a process ID is expected
+
+#define REPORT_PROCESSES 1u              // Reports list the input, the completion order and every process's results
+#define REPORT_LATENCY 2u                // Reports add the turnaround and waiting time percentiles and histograms
+#define REPORT_DEFAULT REPORT_PROCESSES
+
+/*
+ * A process is identified by its 32-bit process ID, which is also its position in the input.
+ * Its fields are split by how often the scheduling loop touches them, so the hot state of
+ * every process is packed together instead of being interleaved with fields the loop never reads.
+ */
+
+/* The input description of a process. Read-only once loaded, so every run shares one table */
+typedef struct ProcessSpec {
+    uint32_t A;                         // A: Arrival time of the process
+    uint32_t B;                         // B: Upper Bound of CPU burst times of the given random integer list
+    uint32_t C;                         // C: Total CPU time required
+    uint32_t M;                         // M: Multiplier of CPU burst time
+} _process_spec;
+
+/* The scheduling state of a process, read and written on every event */
+typedef struct ProcessState {
+    uint32_t CPUBurst;                  // The CPU availability of the process (has to be > 1 to move to running)
+    uint32_t IOBurst;                   // The length of the I/O burst following the current CPU burst
+    uint32_t currentCPUTimeRun;         // The amount of time the process has already run (time in running state)
+    uint32_t readySinceCycle;           // The cycle the process last entered the ready state
+    int32_t quantum;                    // Used for schedulers that utilise pre-emption
+    uint8_t status;                     // 0 is unstarted, 1 is ready, 2 is running, 3 is blocked, 4 is terminated
+    uint8_t isFirstTimeRunning;         // Used to check when to calculate the CPU burst when it hits running mode
+    uint8_t level;                      // The MLFQ level the process is queued on (0 is the highest)
+} _process_state;
+
+/* The results of a process, written when it changes state and read by the reports */
+typedef struct ProcessStats {
+    int32_t finishingTime;              // The cycle when the the process finishes (initially -1)
+    uint32_t currentIOBlockedTime;      // The amount of time the process has been IO blocked (time in blocked state)
+    uint32_t currentWaitingTime;        // The amount of time spent waiting to be run (time in ready state)
+} _process_stats;
+
+/* The work one CPU did in a multi-CPU run */
+typedef struct CoreStats {
+    uint32_t busyCycles;                // Cycles the CPU spent running a process
+    uint32_t dispatches;                // Processes the CPU started running
+    uint32_t steals;                    // Processes the CPU took from another CPU's run queue
+    uint32_t finished;                  // Processes that finished on the CPU
+} _core_stats;
+
+/* Processes in the order they arrive, consumed by the schedulers through a cursor */
+typedef struct ArrivalIndex {
+    const uint32_t* order;              // Indices into the process list, sorted by arrival time then process ID
+    uint32_t count;                     // The number of indexed processes
+    uint32_t cursor;                    // The position of the next process that has yet to arrive
+} _arrival_index;
+
+typedef struct Checkpoint _checkpoint;  // Where a run is snapshotted to and resumed from (see checkpoint.h)
+
+/* The state of one scheduling run. Each run owns its process state, so runs can execute side by side */
+typedef struct Simulation {
+    const _process_spec* specs;         // The shared input table, indexed by process ID
+    _process_state* states;             // This run's scheduling state, indexed by process ID
+    _process_stats* stats;              // This run's per-process results, indexed by process ID
+    uint32_t* completionOrder;          // The IDs of the finished processes, in the order they finished
+    _core_stats* cores;                 // Per-CPU results of a multi-CPU run (NULL on one CPU)
+    _histogram* turnaroundHistogram;    // The turnaround time of every finished process
+    _histogram* waitingHistogram;       // The waiting time of every finished process
+    _arena arena;                       // Holds states, stats, completionOrder, cores and the histograms
+    _arrival_index arrivals;            // The shared arrival order, with this run's own cursor
+    const _random_source* randomSource; // The shared, read-only random number table
+    const uint32_t* randomIndex;        // The index each process draws its bursts with (NULL: its process ID)
+    _trace_writer* trace;               // Where state transitions are logged (NULL when tracing is off)
+    _checkpoint* checkpoint;            // Where the run is snapshotted to and resumed from (NULL when neither is)
+
+    uint32_t currentCycle;              // The current cycle that each process is on
+    uint32_t totalCreatedProcesses;     // The total number of processes constructed
+    uint32_t totalStartedProcesses;     // The total number of processes that have started being simulated
+    uint32_t totalFinishedProcesses;    // The total number of processes that have finished running
+    uint32_t totalCyclesSpentBlocked;   // The total cycles in the blocked state
+    uint32_t blockedSinceCycle;         // The cycle the blocked set last went from empty to non-empty
+    uint32_t quantum;                   // The time slice given to each process by preemptive schedulers
+    uint32_t cpuCount;                  // The CPUs of a multi-CPU run (0 runs the uniprocessor engines)
+    uint32_t migrations;                // Dispatches onto a different CPU than the process last ran on
+    uint64_t eventCount;                // Cycles actually simulated; skip_to_next_event jumps over the rest
+    uint32_t reportFlags;               // REPORT_* flags: what write_report includes (REPORT_DEFAULT unless changed)
+#ifdef SCHEDULER_PROFILE
+    _profile profile;                   // The work this run did and how long its phases took
+#endif
+} _simulation;
+
+/* The metrics printed by printSummaryData */
+typedef struct SummaryData {
+    uint32_t finishingTime;             // The cycle the last process finished on
+    double cpuUtilisation;              // Fraction of cycles a process was running
+    double ioUtilisation;               // Fraction of cycles at least one process was blocked
+    double throughput;                  // Processes finished per hundred cycles
+    double averageTurnaroundTime;       // Mean of finishing time minus arrival time
+    double averageWaitingTime;          // Mean time spent in the ready state
+} _summary_data;
+
+typedef struct SchedulingPolicy _scheduling_policy; // How a run queues, picks and preempts (see policy.h)
+typedef struct PolicyQueue _policy_queue;
+
+/* A scheduling algorithm and the names its report is printed under */
+typedef struct SchedulingAlgorithm {
+    const char* name;                   // Used in "The scheduling algorithm used was ..."
+    const char* banner;                 // Used in the START OF / END OF banners
+    const char* key;                    // Short name used in file names and CSV output
+    bool usesQuantum;                   // Whether the run depends on the quantum
+    const _scheduling_policy* policy;   // The policy the engines run it under
+    int (*run)(_simulation* sim);       // Simulates the whole run on one CPU: 0, or -1 if it can't be set up
+    int (*reference)(_simulation* sim); // Simulates the whole run cycle by cycle (NULL if there's no reference.h engine)
+} _scheduling_algorithm;
+
+#define ALGORITHM_COUNT 6
+#define DEFAULT_ALGORITHM_COUNT 3       // FCFS, RR and SJF, the algorithms run unless others are asked for
+extern const _scheduling_algorithm ALGORITHMS[ALGORITHM_COUNT]; // FCFS, RR, SJF, SRTF, MLFQ and priority, in report order
+
+extern const char* RANDOM_NUMBER_FILE_NAME;
+extern const uint32_t SEED_VALUE;
+extern uint32_t QUANTUM;                // The default RR quantum
+
+uint32_t getRandNumFromFile(uint32_t line, const _random_source* random_source);
+uint32_t randomOS(uint32_t upper_bound, uint32_t process_indx, const _random_source* random_source);
+
+void printStart(const _simulation* sim, _report_writer* out);
+void printFinal(const _simulation* sim, _report_writer* out);
+void printProcessSpecifics(const _simulation* sim, _report_writer* out);
+void printSummaryData(const _simulation* sim, _report_writer* out);
+void printSummary(const _summary_data* summary, _report_writer* out);
+void printSMPData(const _simulation* sim, _report_writer* out);
+void printLatencyData(const _simulation* sim, _report_writer* out);
+void compute_summary(const _simulation* sim, _summary_data* summary);
+
+/**
+ * Reads a workload file ("count (A B C M) ...") into a newly allocated process list.
+ * Returns 0 on success, -1 if the file can't be opened, -2 if it can't be allocated,
+ * -3 if it is malformed, in which case error (when not NULL) receives the line and the problem.
+ */
+int load_processes(const char* file_name, _process_spec** process_list, uint32_t* count,
+                   char* error, size_t error_length);
+
+int build_arrival_index(const _process_spec process_list[], uint32_t count, _arrival_index* arrivals);
+
+/**
+ * Prepares sim to run over the count processes in input, which must outlive it, on cpu_count CPUs
+ * (0 for the uniprocessor engines). Returns 0 on success, -1 if the run's process state can't be allocated.
+ */
+int simulation_init(_simulation* sim, const _process_spec input[], uint32_t count,
+                    const _arrival_index* arrivals, const _random_source* randomSource, uint32_t quantum,
+                    uint32_t cpu_count);
+void simulation_free(_simulation* sim);
+
+/**
+ * Runs algorithm over sim, on the multi-CPU engine when sim has CPUs, and writes its full report, banners included, to out.
+ * Returns 0 on success, -1 without writing anything if the run can't be set up (out of memory, or a checkpoint
+ * that can't be resumed, in which case (*(*sim).checkpoint).status says so).
+ */
+int run_and_report(const _scheduling_algorithm* algorithm, _simulation* sim, _report_writer* out);
+
+/**
+ * Writes the full report of sim, a finished run of algorithm, to out
+ */
+void write_report(const _scheduling_algorithm* algorithm, const _simulation* sim, _report_writer* out);
+
+/**
+ * Names the output of algorithm over input_path: <directory>/<input name>.<key>[.q<quantum>]<suffix>
+ * Returns 0 on success, -1 if the name doesn't fit in length bytes.
+ */
+int report_file_name(char* name, size_t length, const char* directory, const char* input_path,
+                     const _scheduling_algorithm* algorithm, uint32_t quantum, const char* suffix);
+
+/**
+ * Runs algorithm over sim, tracing the run to trace_name, and writes its full report to out.
+ * Returns 0 on success, -1 if the trace can't be written, -2 if the run can't be set up (nothing is written to out).
+ */
+int run_and_report_traced(const _scheduling_algorithm* algorithm, _simulation* sim, _report_writer* out,
+                          const char* trace_name);
+
+void initialize_processes(_simulation* sim);
+void initialize_process(_simulation* sim, uint32_t process);
+void start_process(_simulation* sim, uint32_t process);
+void process_finished(_simulation* sim, uint32_t process);
+uint32_t next_arrival(_simulation* sim);
+void block(_simulation* sim, uint32_t newBlocked, _blocked_set* blocked);
+uint32_t next_unblocked(_simulation* sim, _blocked_set* blocked);
+int FCFS(_simulation* sim);
+int RR(_simulation* sim);
+int SJF(_simulation* sim);
+int SRTF(_simulation* sim);
+int MLFQ(_simulation* sim);
+int PRIORITY(_simulation* sim);
+
+#endif
@@ -0,0 +1,773 @@
+#include "server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "report_writer.h"
+#include "thread_pool.h"
+
+#define SERVER_BACKLOG 64               // Connections the kernel holds before the poller accepts them
+#define SERVER_RETRY_MS 100             // How soon the poller retries a request it had no memory to hand to a worker
+
+/* A parsed workload, shared by every request for it */
+typedef struct CachedWorkload {
+    char* path;                         // The absolute path the workload was read from
+    struct timespec modified;           // The file's modification time when it was read
+    off_t size;                         // The file's size when it was read
+    _process_spec* specs;               // The processes, as load_processes read them
+    uint32_t count;                     // The number of processes
+    _arrival_index arrivals;            // The arrival order of the processes
+    uint32_t users;                     // Requests running on the workload right now
+    uint64_t lastUsed;                  // The cache clock when the workload was last handed out
+    bool cached;                        // Whether the cache holds it (otherwise its last user frees it)
+} _cached_workload;
+
+typedef struct ServerConnection _server_connection;
+
+/* The state every worker shares */
+typedef struct Server {
+    _random_source randomSource;        // The random table, loaded once
+    pthread_mutex_t lock;               // Guards the cache and the busy and closing flags of the connections
+    _cached_workload* cache[SERVER_CACHE_ENTRIES]; // The cached workloads (NULL in free entries)
+    uint64_t clock;                     // Ticks once per cache lookup, for least recently used eviction
+    _server_connection* connections;    // The open connections, a list only the poller walks
+} _server;
+
+/* A client connection and the bytes of its requests the server hasn't handled yet */
+struct ServerConnection {
+    _server* server;                    // The server the connection belongs to
+    int fd;                             // The connected socket
+    char buffer[SERVER_REQUEST_LENGTH]; // Bytes received and not yet consumed (the worker's while busy, the poller's otherwise)
+    size_t length;                      // The number of bytes in buffer
+    bool busy;                          // Whether a worker is serving one of its requests
+    bool closing;                       // Whether the peer has gone, so the poller closes it
+    _server_connection* next;           // The next open connection
+};
+
+/* The descriptors the poller waits on: the wake-up pipe, the listener, then every idle connection */
+typedef struct PollSet {
+    struct pollfd* fds;                 // The descriptors and the events that came in on them
+    _server_connection** connections;   // The connection behind each of fds (NULL for the pipe and the listener)
+    uint32_t count;                     // The number of descriptors
+    uint32_t capacity;                  // The number of descriptors allocated
+} _poll_set;
+
+static volatile sig_atomic_t stopping = 0;
+static int wake_pipe[2] = { -1, -1 };   // Written to by the signal handler and by workers handing a connection back
+
+/**
+ * Wakes the poller. Safe in a signal handler; when the pipe is full a wake-up is already pending.
+ */
+static void wake_poller(void)
+{
+    int saved_errno = errno;
+    ssize_t written = write(wake_pipe[1], "", 1);
+    (void) written;
+    errno = saved_errno;
+}
+
+static void stop_serving(int signal_number)
+{
+    (void) signal_number;
+    stopping = 1;
+    wake_poller();
+}
+
+/**
+ * Writes length bytes of data to fd. Returns 0 on success, -1 if the peer has gone.
+ */
+static int send_all(int fd, const void* data, size_t length)
+{
+    const char* bytes = data;
+    while (length){
+        ssize_t sent = send(fd, bytes, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR){
+            continue;
+        }
+        if (sent <= 0){
+            return -1;
+        }
+        bytes += sent;
+        length -= (size_t) sent;
+    }
+    return 0;
+}
+
+/**
+ * Reads exactly length bytes from fd into data. Returns 0 on success, -1 if the peer closed first.
+ */
+static int receive_all(int fd, void* data, size_t length)
+{
+    char* bytes = data;
+    while (length){
+        ssize_t received = recv(fd, bytes, length, 0);
+        if (received < 0 && errno == EINTR){
+            continue;
+        }
+        if (received <= 0){
+            return -1;
+        }
+        bytes += received;
+        length -= (size_t) received;
+    }
+    return 0;
+}
+
+/**
+ * Reads a line of at most length - 1 bytes from fd into line, without its newline, a byte at a time so
+ * nothing after it is consumed. Returns 0 on success, -1 if the peer closed first or the line is too long.
+ */
+static int receive_line(int fd, char* line, size_t length)
+{
+    for (size_t i = 0; i < length; i++){
+        if (receive_all(fd, &line[i], 1) != 0){
+            return -1;
+        }
+        if (line[i] == '\n'){
+            line[i] = '\0';
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Takes the next request line off connection, without its newline, into line (SERVER_REQUEST_LENGTH bytes).
+ * Returns 0 on success, -1 if no complete line has been received yet.
+ */
+static int take_request(_server_connection* connection, char* line)
+{
+    char* newline = memchr((*connection).buffer, '\n', (*connection).length);
+    if (!newline){
+        return -1;
+    }
+    size_t length = (size_t) (newline - (*connection).buffer);
+    memcpy(line, (*connection).buffer, length);
+    line[length] = '\0';
+    (*connection).length -= length + 1;
+    memmove((*connection).buffer, newline + 1, (*connection).length);
+    return 0;
+}
+
+/**
+ * Reads what the peer of an idle connection has sent, without waiting for more. Returns 0 if the connection
+ * can carry on, -1 if the peer closed it or sent a line too long to be a request.
+ */
+static int receive_requests(_server_connection* connection)
+{
+    ssize_t received = recv((*connection).fd, (*connection).buffer + (*connection).length,
+                            sizeof((*connection).buffer) - (*connection).length, MSG_DONTWAIT);
+    if (received < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)){
+        return 0;
+    }
+    if (received <= 0){
+        return -1;
+    }
+    (*connection).length += (size_t) received;
+    return (*connection).length == sizeof((*connection).buffer)
+           && !memchr((*connection).buffer, '\n', (*connection).length) ? -1 : 0;
+}
+
+// The workload cache ----------
+
+static void free_workload(_cached_workload* workload)
+{
+    free((void*) (*workload).arrivals.order);
+    free((*workload).specs);
+    free((*workload).path);
+    free(workload);
+}
+
+/**
+ * Parses path into a new workload. Returns NULL with why set if it can't be read.
+ */
+static _cached_workload* load_workload(const char* path, const struct stat* file_stat, char* why, size_t why_length)
+{
+    _cached_workload* workload = calloc(1, sizeof(_cached_workload));
+    char error[128];
+    if (!workload || !((*workload).path = strdup(path))){
+        free(workload);
+        snprintf(why, why_length, "out of memory");
+        return NULL;
+    }
+    (*workload).modified = (*file_stat).st_mtim;
+    (*workload).size = (*file_stat).st_size;
+    int loaded = load_processes(path, &(*workload).specs, &(*workload).count, error, sizeof(error));
+    if (loaded == 0 && build_arrival_index((*workload).specs, (*workload).count, &(*workload).arrivals) != 0){
+        free((*workload).specs);
+        loaded = -2;
+    }
+    if (loaded != 0){
+        if (loaded == -1){
+            snprintf(why, why_length, "%s not found", path);
+        }
+        else if (loaded == -3){
+            snprintf(why, why_length, "%s: %s", path, error);
+        }
+        else{
+            snprintf(why, why_length, "out of memory loading %s", path);
+        }
+        free((*workload).path);
+        free(workload);
+        return NULL;
+    }
+    return workload;
+}
+
+/**
+ * Whether workload was read from the file described by file_stat as it is now
+ */
+static bool workload_current(const _cached_workload* workload, const struct stat* file_stat)
+{
+    return (*workload).size == (*file_stat).st_size && (*workload).modified.tv_sec == (*file_stat).st_mtim.tv_sec
+           && (*workload).modified.tv_nsec == (*file_stat).st_mtim.tv_nsec;
+}
+
+/**
+ * Drops the cache entry i. Its workload is freed now, or by its last user.
+ */
+static void evict_entry(_server* server, uint32_t i)
+{
+    _cached_workload* workload = (*server).cache[i];
+    (*server).cache[i] = NULL;
+    (*workload).cached = false;
+    if (!(*workload).users){
+        free_workload(workload);
+    }
+}
+
+/**
+ * Returns the workload in path, from the cache while the file is unchanged, for the caller to release_workload.
+ * Returns NULL with why set if it can't be read.
+ */
+static _cached_workload* acquire_workload(_server* server, const char* path, char* why, size_t why_length)
+{
+    struct stat file_stat;
+    if (stat(path, &file_stat) != 0){
+        snprintf(why, why_length, "%s not found", path);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&(*server).lock);
+    for (uint32_t i = 0; i < SERVER_CACHE_ENTRIES; i++){
+        _cached_workload* workload = (*server).cache[i];
+        if (workload && strcmp((*workload).path, path) == 0){
+            if (workload_current(workload, &file_stat)){
+                (*workload).users++;
+                (*workload).lastUsed = ++(*server).clock;
+                pthread_mutex_unlock(&(*server).lock);
+                return workload;
+            }
+            evict_entry(server, i);
+        }
+    }
+    pthread_mutex_unlock(&(*server).lock);
+
+    // Parsed outside the lock, so requests for cached workloads never wait on a parse
+    _cached_workload* loaded = load_workload(path, &file_stat, why, why_length);
+    if (!loaded){
+        return NULL;
+    }
+
+    pthread_mutex_lock(&(*server).lock);
+    uint32_t victim = SERVER_CACHE_ENTRIES;        // A free entry if there is one, else the least recently used
+    uint64_t victim_last_used = 0;                  // Free entries count as never used
+    for (uint32_t i = 0; i < SERVER_CACHE_ENTRIES; i++){
+        _cached_workload* workload = (*server).cache[i];
+        if (workload && strcmp((*workload).path, path) == 0 && workload_current(workload, &file_stat)){
+            // Another request parsed it meanwhile
+            (*workload).users++;
+            (*workload).lastUsed = ++(*server).clock;
+            pthread_mutex_unlock(&(*server).lock);
+            free_workload(loaded);
+            return workload;
+        }
+        uint64_t last_used = workload ? (*workload).lastUsed : 0;
+        if (victim == SERVER_CACHE_ENTRIES || last_used < victim_last_used){
+            victim = i;
+            victim_last_used = last_used;
+        }
+    }
+    if ((*server).cache[victim]){
+        evict_entry(server, victim);
+    }
+    (*server).cache[victim] = loaded;
+    (*loaded).cached = true;
+    (*loaded).users = 1;
+    (*loaded).lastUsed = ++(*server).clock;
+    pthread_mutex_unlock(&(*server).lock);
+    return loaded;
+}
+
+static void release_workload(_server* server, _cached_workload* workload)
+{
+    pthread_mutex_lock(&(*server).lock);
+    (*workload).users--;
+    bool unused = !(*workload).users && !(*workload).cached;
+    pthread_mutex_unlock(&(*server).lock);
+    if (unused){
+        free_workload(workload);
+    }
+}
+
+// Requests ----------
+
+/**
+ * Sends an ERR reply. Returns 0 if it was sent, -1 if the peer has gone.
+ */
+static int send_error(int fd, const char* why)
+{
+    char reply[256];
+    int length = snprintf(reply, sizeof(reply), "ERR %s\n", why);
+    return send_all(fd, reply, length < (int) sizeof(reply) ? (size_t) length : sizeof(reply) - 1);
+}
+
+/**
+ * Sends an OK reply carrying length bytes of payload. Returns 0 if it was sent, -1 if the peer has gone.
+ */
+static int send_payload(int fd, const void* payload, size_t length)
+{
+    char header[32];
+    int header_length = snprintf(header, sizeof(header), "OK %zu\n", length);
+    return send_all(fd, header, (size_t) header_length) == 0 && send_all(fd, payload, length) == 0 ? 0 : -1;
+}
+
+/**
+ * Runs the request in line and sends its reply. Returns 0 if the connection can carry on, -1 if the peer has gone.
+ */
+static int serve_request(_server* server, int fd, const char* line)
+{
+    char key[16], format[16], why[BATCH_PATH_LENGTH + 64];
+    uint32_t quantum, flags;
+    int path_start = 0;
+
+    if (sscanf(line, "RUN %15s %u %u %15s %n", key, &quantum, &flags, format, &path_start) != 4 || !path_start){
+        return send_error(fd, "malformed request");
+    }
+    const char* path = line + path_start;
+    const _scheduling_algorithm* algorithm = NULL;
+    for (uint32_t i = 0; i < ALGORITHM_COUNT; i++){
+        if (strcmp(ALGORITHMS[i].key, key) == 0){
+            algorithm = &ALGORITHMS[i];
+        }
+    }
+    bool report = strcmp(format, SERVER_FORMAT_REPORT) == 0;
+    if (!algorithm){
+        return send_error(fd, "unknown algorithm");
+    }
+    if (!report && strcmp(format, SERVER_FORMAT_SUMMARY) != 0){
+        return send_error(fd, "unknown format");
+    }
+    if (quantum == 0){
+        return send_error(fd, "invalid quantum");
+    }
+    if (path[0] != '/'){
+        return send_error(fd, "input path must be absolute");
+    }
+
+    _cached_workload* workload = acquire_workload(server, path, why, sizeof(why));
+    if (!workload){
+        return send_error(fd, why);
+    }
+    _simulation sim;
+    int status;
+    if (simulation_init(&sim, (*workload).specs, (*workload).count, &(*workload).arrivals, &(*server).randomSource,
+                        quantum, 0) != 0){
+        release_workload(server, workload);
+        return send_error(fd, "out of memory");
+    }
+    sim.reportFlags = flags;
+    if (report){
+        _report_writer out;
+        char* text = NULL;
+        size_t length = 0;
+        if (report_writer_init(&out, NULL) == 0){
+            int ran = run_and_report(algorithm, &sim, &out);
+            text = report_writer_take(&out, &length);
+            if (ran != 0){
+                free(text);
+                text = NULL;
+            }
+        }
+        status = text ? send_payload(fd, text, length) : send_error(fd, "out of memory");
+        free(text);
+    }
+    else if ((*algorithm).run(&sim) != 0){
+        status = send_error(fd, "out of memory");
+    }
+    else{
+        _summary_data summary;
+        _server_summary reply;
+        compute_summary(&sim, &summary);
+        memset(&reply, 0, sizeof(reply));
+        reply.finishingTime = summary.finishingTime;
+        reply.processCount = (*workload).count;
+        reply.cpuUtilisation = summary.cpuUtilisation;
+        reply.ioUtilisation = summary.ioUtilisation;
+        reply.throughput = summary.throughput;
+        reply.averageTurnaroundTime = summary.averageTurnaroundTime;
+        reply.averageWaitingTime = summary.averageWaitingTime;
+        status = send_payload(fd, &reply, sizeof(reply));
+    }
+    simulation_free(&sim);
+    release_workload(server, workload);
+    return status;
+}
+
+/**
+ * Serves the next request of a busy connection, then hands the connection back to the poller
+ */
+static void serve_next_request(void* argument)
+{
+    _server_connection* connection = argument;
+    _server* server = (*connection).server;
+    char line[SERVER_REQUEST_LENGTH];
+
+    int status = take_request(connection, line) == 0 ? serve_request(server, (*connection).fd, line) : 0;
+    pthread_mutex_lock(&(*server).lock);
+    (*connection).busy = false;
+    (*connection).closing = status != 0;
+    pthread_mutex_unlock(&(*server).lock);
+    wake_poller();
+}
+
+// The server ----------
+
+/**
+ * Fills address with path. Returns 0 on success, -1 if path is too long for a socket address.
+ */
+static int socket_address(struct sockaddr_un* address, const char* path)
+{
+    memset(address, 0, sizeof(*address));
+    (*address).sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof((*address).sun_path)){
+        return -1;
+    }
+    strcpy((*address).sun_path, path);
+    return 0;
+}
+
+/**
+ * Makes reads and writes on fd return at once instead of waiting. Returns 0 on success, -1 on failure.
+ */
+static int set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0 ? 0 : -1;
+}
+
+/**
+ * Adds fd, and the connection behind it, to set. Returns 0 on success, -1 if there's no memory for it.
+ */
+static int poll_set_add(_poll_set* set, int fd, _server_connection* connection)
+{
+    if ((*set).count == (*set).capacity){
+        uint32_t grown = (*set).capacity ? (*set).capacity * 2 : 64;
+        struct pollfd* fds = realloc((*set).fds, grown * sizeof(struct pollfd));
+        if (!fds){
+            return -1;
+        }
+        (*set).fds = fds;
+        _server_connection** connections = realloc((*set).connections, grown * sizeof(_server_connection*));
+        if (!connections){
+            return -1;
+        }
+        (*set).connections = connections;
+        (*set).capacity = grown;
+    }
+    (*set).fds[(*set).count].fd = fd;
+    (*set).fds[(*set).count].events = POLLIN;
+    (*set).fds[(*set).count].revents = 0;
+    (*set).connections[(*set).count++] = connection;
+    return 0;
+}
+
+/**
+ * Hands the next request of every idle connection that has a complete one to a worker, closes the connections
+ * whose peer has gone, and puts the other idle connections after the pipe and the listener in set.
+ * Returns the timeout to poll with: -1, or SERVER_RETRY_MS if something was left for lack of memory.
+ */
+static int prepare_poll(_server* server, _thread_pool* pool, _poll_set* set)
+{
+    int timeout = -1;
+    (*set).count = 2;
+    pthread_mutex_lock(&(*server).lock);
+    _server_connection** link = &(*server).connections;
+    while (*link){
+        _server_connection* connection = *link;
+        if ((*connection).closing && !(*connection).busy){
+            *link = (*connection).next;
+            close((*connection).fd);
+            free(connection);
+            continue;
+        }
+        // A busy connection's worker owns its buffer and wakes the poller when it hands the connection back
+        if (!(*connection).busy && memchr((*connection).buffer, '\n', (*connection).length)){
+            (*connection).busy = true;
+            if (thread_pool_submit(pool, serve_next_request, connection) != 0){
+                (*connection).busy = false;
+                timeout = SERVER_RETRY_MS;
+            }
+        }
+        else if (!(*connection).busy && poll_set_add(set, (*connection).fd, connection) != 0){
+            timeout = SERVER_RETRY_MS;
+        }
+        link = &(*connection).next;
+    }
+    pthread_mutex_unlock(&(*server).lock);
+    return timeout;
+}
+
+/**
+ * Accepts the pending connection on listener, if it is still there, onto the server's list
+ */
+static void accept_connection(_server* server, int listener)
+{
+    int fd = accept(listener, NULL, NULL);
+    if (fd < 0){
+        return;
+    }
+    _server_connection* connection = calloc(1, sizeof(_server_connection));
+    if (!connection){
+        close(fd);
+        return;
+    }
+    // Replies are sent from the workers and wait for the peer to read them, whatever the listener's mode
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    (*connection).server = server;
+    (*connection).fd = fd;
+    (*connection).next = (*server).connections;
+    (*server).connections = connection;
+}
+
+int run_server(const char* socket_path, uint32_t thread_count)
+{
+    static _server server;
+    struct sockaddr_un address;
+    struct stat existing;
+
+    if (socket_address(&address, socket_path) != 0){
+        printf("socket path too long: %s\n", socket_path);
+        return -1;
+    }
+    // A socket left behind by a server that was killed would fail the bind, but one a server still answers on is its
+    if (stat(socket_path, &existing) == 0 && S_ISSOCK(existing.st_mode)){
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        int connected = probe >= 0 ? connect(probe, (struct sockaddr*) &address, sizeof(address)) : -1;
+        int refused = connected != 0 && errno == ECONNREFUSED;
+        if (probe >= 0){
+            close(probe);
+        }
+        if (connected == 0){
+            printf("a server is already listening on %s\n", socket_path);
+            return -1;
+        }
+        if (refused){
+            unlink(socket_path);
+        }
+    }
+    if (random_source_load(&server.randomSource, RANDOM_NUMBER_FILE_NAME) != 0){
+        printf("%s not found\n", RANDOM_NUMBER_FILE_NAME);
+        return -1;
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, (struct sockaddr*) &address, sizeof(address)) != 0
+            || listen(listener, SERVER_BACKLOG) != 0){
+        printf("can't listen on %s\n", socket_path);
+        if (listener >= 0){
+            close(listener);
+        }
+        random_source_free(&server.randomSource);
+        return -1;
+    }
+    pthread_mutex_init(&server.lock, NULL);
+
+    _poll_set polled = { 0 };
+    _thread_pool* pool = NULL;
+    int status = 0;
+    if (pipe(wake_pipe) == 0 && set_nonblocking(wake_pipe[0]) == 0 && set_nonblocking(wake_pipe[1]) == 0
+            && set_nonblocking(listener) == 0 && poll_set_add(&polled, wake_pipe[0], NULL) == 0
+            && poll_set_add(&polled, listener, NULL) == 0){
+        // The handler wakes the poll below through the pipe, so a signal that comes just before it isn't missed.
+        // The workers start with SIGINT and SIGTERM blocked, so the signals never interrupt a reply.
+        struct sigaction action;
+        sigset_t signals, previous;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = stop_serving;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, &previous);
+        pool = thread_pool_create(thread_count);
+        pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    }
+    if (!pool){
+        printf("can't start %u workers on %s\n", thread_count, socket_path);
+        status = -1;
+    }
+    else{
+        printf("Serving on %s with %u workers\n", socket_path, thread_count);
+        fflush(stdout);
+    }
+
+    // The poller: idle connections are read here, and each complete request goes to a worker on its own
+    while (pool && !stopping){
+        int timeout = prepare_poll(&server, pool, &polled);
+        if (poll(polled.fds, polled.count, timeout) <= 0){
+            continue;
+        }
+        if (polled.fds[0].revents){
+            char drained[64];
+            while (read(wake_pipe[0], drained, sizeof(drained)) > 0){
+            }
+        }
+        if (polled.fds[1].revents){
+            accept_connection(&server, listener);
+        }
+        for (uint32_t i = 2; i < polled.count; i++){
+            if (polled.fds[i].revents && receive_requests(polled.connections[i]) != 0){
+                (*polled.connections[i]).closing = true;
+            }
+        }
+    }
+
+    // Wakes the workers still sending a reply, so the pool can finish
+    pthread_mutex_lock(&server.lock);
+    for (_server_connection* connection = server.connections; connection; connection = (*connection).next){
+        if ((*connection).busy){
+            shutdown((*connection).fd, SHUT_RDWR);
+        }
+    }
+    pthread_mutex_unlock(&server.lock);
+    thread_pool_destroy(pool);
+    while (server.connections){
+        _server_connection* connection = server.connections;
+        server.connections = (*connection).next;
+        close((*connection).fd);
+        free(connection);
+    }
+    for (uint32_t i = 0; i < 2; i++){
+        if (wake_pipe[i] >= 0){
+            close(wake_pipe[i]);
+            wake_pipe[i] = -1;
+        }
+    }
+    free(polled.fds);
+    free(polled.connections);
+    close(listener);
+    unlink(socket_path);
+    for (uint32_t i = 0; i < SERVER_CACHE_ENTRIES; i++){
+        if (server.cache[i]){
+            free_workload(server.cache[i]);
+        }
+    }
+    pthread_mutex_destroy(&server.lock);
+    random_source_free(&server.randomSource);
+    if (status == 0){
+        printf("Stopped serving on %s\n", socket_path);
+    }
+    return status;
+}
+
+// The client ----------
+
+/**
+ * Sends request and reads its reply into a new buffer, returned with its length.
+ * Returns NULL if the request failed, after printing why.
+ */
+static char* client_request(int fd, const char* request, size_t* length)
+{
+    char header[SERVER_REQUEST_LENGTH];
+    if (send_all(fd, request, strlen(request)) != 0 || receive_line(fd, header, sizeof(header)) != 0){
+        printf("the server closed the connection\n");
+        return NULL;
+    }
+    if (strncmp(header, "OK ", 3) != 0){
+        printf("%s\n", strncmp(header, "ERR ", 4) == 0 ? header + 4 : header);
+        return NULL;
+    }
+    *length = strtoull(header + 3, NULL, 10);
+    char* reply = malloc(*length ? *length : 1);
+    if (!reply || receive_all(fd, reply, *length) != 0){
+        printf(reply ? "the server closed the connection\n" : "Out of memory reading a reply\n");
+        free(reply);
+        return NULL;
+    }
+    return reply;
+}
+
+int run_client(const char* socket_path, const char* input_path, const _batch_config* config, bool summaries)
+{
+    struct sockaddr_un address;
+    char path[BATCH_PATH_LENGTH];
+    char request[SERVER_REQUEST_LENGTH];
+
+    if (!realpath(input_path, path)){
+        printf("%s not found\n", input_path);
+        return -1;
+    }
+    if (socket_address(&address, socket_path) != 0){
+        printf("socket path too long: %s\n", socket_path);
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*) &address, sizeof(address)) != 0){
+        printf("can't connect to %s\n", socket_path);
+        if (fd >= 0){
+            close(fd);
+        }
+        return -1;
+    }
+
+    if (summaries){
+        printf("algorithm,quantum,processes,finishing_time,cpu_utilisation,io_utilisation,throughput,"
+               "average_turnaround,average_waiting\n");
+    }
+    int status = 0;
+    for (uint32_t i = 0; i < (*config).algorithmCount && status == 0; i++){
+        const _scheduling_algorithm* algorithm = (*config).algorithms[i];
+        for (uint32_t k = 0; k < ((*algorithm).usesQuantum ? (*config).quantumCount : 1) && status == 0; k++){
+            uint32_t quantum = (*algorithm).usesQuantum ? (*config).quanta[k] : QUANTUM;
+            size_t length;
+            snprintf(request, sizeof(request), "RUN %s %u %u %s %s\n", (*algorithm).key, quantum,
+                     (*config).reportFlags, summaries ? SERVER_FORMAT_SUMMARY : SERVER_FORMAT_REPORT, path);
+            char* reply = client_request(fd, request, &length);
+            if (!reply){
+                status = -1;
+            }
+            else if (!summaries){
+                fwrite(reply, 1, length, stdout);
+            }
+            else if (length != sizeof(_server_summary)){
+                printf("the server sent a summary of %zu bytes\n", length);
+                status = -1;
+            }
+            else{
+                _server_summary summary;
+                memcpy(&summary, reply, sizeof(summary));
+                printf("%s,%u,%u,%u,%.6f,%.6f,%.6f,%.6f,%.6f\n", (*algorithm).key, quantum, summary.processCount,
+                       summary.finishingTime, summary.cpuUtilisation, summary.ioUtilisation, summary.throughput,
+                       summary.averageTurnaroundTime, summary.averageWaitingTime);
+            }
+            free(reply);
+        }
+    }
+    close(fd);
+    if (status == 0 && !summaries){
+        printf("\n");
+    }
+    return status;
+}
@@ -0,0 +1,51 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdint.h>
+
+#include "batch.h"
+
+#define SERVER_CACHE_ENTRIES 16         // Parsed workloads kept between requests, least recently used evicted first
+#define SERVER_REQUEST_LENGTH (BATCH_PATH_LENGTH + 64) // Longest request line, newline included
+#define SERVER_FORMAT_REPORT "report"   // Requests the report text, exactly as a plain run prints it
+#define SERVER_FORMAT_SUMMARY "summary" // Requests a _server_summary
+
+/*
+ * The server mode. The server listens on a Unix domain socket with the random table loaded once and keeps
+ * the last SERVER_CACHE_ENTRIES workloads it parsed (checked against their size and modification time on
+ * every use). A connection can carry any number of requests, one line each:
+ *   RUN <algorithm key> <quantum> <REPORT_* flags> <report|summary> <absolute input path>\n
+ * answered by
+ *   OK <length>\n followed by length bytes: the report text, or a _server_summary
+ *   ERR <reason>\n
+ * The quantum is the one the run is simulated with, so algorithms that don't use one should be sent QUANTUM.
+ * The accepting thread polls every idle connection and hands each complete request to a worker of the pool
+ * on its own, so a client holds a worker only while one of its requests runs.
+ */
+
+/* The reply to a summary request: the Summary Data of the run, in the server's byte order */
+typedef struct ServerSummary {
+    uint32_t finishingTime;             // The cycle the last process finished on
+    uint32_t processCount;              // The processes in the input
+    double cpuUtilisation;              // Fraction of cycles a process was running
+    double ioUtilisation;               // Fraction of cycles at least one process was blocked
+    double throughput;                  // Processes finished per hundred cycles
+    double averageTurnaroundTime;       // Mean of finishing time minus arrival time
+    double averageWaitingTime;          // Mean time spent in the ready state
+} _server_summary;
+
+/**
+ * Serves requests on socket_path with thread_count workers until SIGINT or SIGTERM.
+ * A stale socket left at socket_path is replaced, but one a server still answers on is not.
+ * Returns 0 once stopped, -1 if the socket or the random numbers can't be set up.
+ */
+int run_server(const char* socket_path, uint32_t thread_count);
+
+/**
+ * Sends one request per algorithm and quantum in config (in the order a plain run reports them) for input_path
+ * to the server on socket_path and prints the replies to stdout: the reports, as a plain run prints them, or
+ * with summaries one CSV row per request. Returns 0 on success, -1 if a request fails.
+ */
+int run_client(const char* socket_path, const char* input_path, const _batch_config* config, bool summaries);
+
+#endif
@@ -0,0 +1,199 @@
+#include "smp.h"
+
+#include <stdlib.h>
+
+#include "policy.h"
+
+/* One simulated CPU */
+typedef struct Core {
+    _policy_queue queue;                // The CPU's run queue
+    uint32_t active;                    // The process running on the CPU (NO_PROCESS when idle)
+} _core;
+
+/**
+ * Returns the CPU with the fewest processes queued or running, the lowest numbered on ties
+ */
+static uint32_t least_loaded(const _core cores[], uint32_t cpu_count)
+{
+    uint32_t best = 0, best_load = UINT32_MAX;
+    for (uint32_t c = 0; c < cpu_count; c++){
+        uint32_t load = cores[c].queue.length + (cores[c].active != NO_PROCESS);
+        if (load < best_load){
+            best = c;
+            best_load = load;
+        }
+    }
+    return best;
+}
+
+/**
+ * Returns the CPU with the longest run queue, the lowest numbered on ties
+ */
+static uint32_t longest_queue(const _core cores[], uint32_t cpu_count)
+{
+    uint32_t best = 0;
+    for (uint32_t c = 1; c < cpu_count; c++){
+        if (cores[c].queue.length > cores[best].queue.length){
+            best = c;
+        }
+    }
+    return best;
+}
+
+/**
+ * Starts process on CPU core, counting a migration if it last ran elsewhere
+ */
+static void dispatch(_simulation* sim, _core cores[], uint32_t core, uint32_t process, uint32_t last_core[])
+{
+    if (last_core[process] != NO_PROCESS && last_core[process] != core){
+        (*sim).migrations++;
+    }
+    last_core[process] = core;
+    cores[core].active = process;
+    (*sim).cores[core].dispatches++;
+    start_process(sim, process);
+}
+
+/**
+ * skip_to_next_event for every CPU at once: jumps to the earliest arrival, I/O completion,
+ * burst end or policy decision on any CPU, applying the skipped cycles in bulk.
+ */
+static void skip_to_next_event_smp(_simulation* sim, _core cores[], _blocked_set* blocked,
+                                   const _scheduling_policy* policy)
+{
+    _arrival_index* arrivals = &(*sim).arrivals;
+    uint32_t last_cycle = (*sim).currentCycle - 1;
+    uint32_t next_cycle = UINT32_MAX;
+
+    if ((*arrivals).cursor < (*arrivals).count){
+        next_cycle = (*sim).specs[(*arrivals).order[(*arrivals).cursor]].A;
+    }
+    if ((*blocked).length && (*blocked).entries[0].wakeCycle < next_cycle){
+        next_cycle = (*blocked).entries[0].wakeCycle;
+    }
+    for (uint32_t c = 0; c < (*sim).cpuCount; c++){
+        if (cores[c].active == NO_PROCESS){
+            continue;
+        }
+        _process_state* state = &(*sim).states[cores[c].active];
+        if (last_cycle + (*state).CPUBurst < next_cycle){
+            next_cycle = last_cycle + (*state).CPUBurst;
+        }
+        if ((*policy).nextDecision){
+            uint32_t decision = (*policy).nextDecision(sim, &cores[c].queue, cores[c].active);
+            next_cycle = decision < next_cycle ? decision : next_cycle;
+        }
+    }
+    if (next_cycle <= (*sim).currentCycle || next_cycle == UINT32_MAX){
+        return;
+    }
+
+    uint32_t skipped = next_cycle - (*sim).currentCycle;
+    PROFILE_COUNT(sim, skips, 1);
+    PROFILE_COUNT(sim, skippedCycles, skipped);
+    for (uint32_t c = 0; c < (*sim).cpuCount; c++){
+        if (cores[c].active == NO_PROCESS){
+            continue;
+        }
+        _process_state* state = &(*sim).states[cores[c].active];
+        (*state).CPUBurst -= skipped;
+        (*state).currentCPUTimeRun += skipped;
+        if ((*policy).timeSliced){
+            (*state).quantum -= skipped;
+        }
+        (*sim).cores[c].busyCycles += skipped;
+    }
+    (*sim).currentCycle = next_cycle;
+}
+
+static void free_cores(_core cores[], uint32_t cpu_count)
+{
+    for (uint32_t c = 0; cores && c < cpu_count; c++){
+        policy_queue_free(&cores[c].queue);
+    }
+    free(cores);
+}
+
+int smp_simulate(_simulation* sim, const _scheduling_policy* policy)
+{
+    uint32_t cpu_count = (*sim).cpuCount, count = (*sim).totalCreatedProcesses, current;
+    _core* cores = calloc(cpu_count, sizeof(_core));
+    uint32_t* last_core = malloc((count ? count : 1) * sizeof(uint32_t));
+    _blocked_set blocked = { 0 };
+    int failed = !cores || !last_core || blocked_set_init(&blocked, count) != 0;
+    for (uint32_t c = 0; !failed && c < cpu_count; c++){
+        cores[c].active = NO_PROCESS;
+        failed = policy_queue_init(&cores[c].queue, policy, count) != 0;
+    }
+    if (failed){
+        free_cores(cores, cpu_count);
+        free(last_core);
+        blocked_set_free(&blocked);
+        return -1;
+    }
+    for (uint32_t i = 0; i < count; i++){
+        last_core[i] = NO_PROCESS;
+    }
+
+    (*sim).arrivals.cursor = 0;
+    while ((*sim).totalFinishedProcesses < count){
+        while ((current = next_unblocked(sim, &blocked)) != NO_PROCESS){
+            make_ready(sim, policy, &cores[last_core[current]].queue, current);
+        }
+        while ((current = next_arrival(sim)) != NO_PROCESS){
+            make_ready(sim, policy, &cores[least_loaded(cores, cpu_count)].queue, current);
+        }
+        for (uint32_t c = 0; c < cpu_count; c++){
+            uint32_t active = cores[c].active;
+            if (active == NO_PROCESS){
+                continue;
+            }
+            _process_state* state = &(*sim).states[active];
+            (*state).CPUBurst -= 1;
+            (*state).currentCPUTimeRun += 1;
+            (*sim).cores[c].busyCycles += 1;
+            if ((*policy).timeSliced){
+                (*state).quantum -= 1;
+            }
+            if ((*state).currentCPUTimeRun == (*sim).specs[active].C){
+                (*sim).stats[active].finishingTime = (*sim).currentCycle;
+                (*state).status = 4;
+                (*sim).cores[c].finished++;
+                process_finished(sim, active);
+                cores[c].active = NO_PROCESS;
+            }
+            else if ((*state).CPUBurst == 0){
+                block(sim, active, &blocked);
+                cores[c].active = NO_PROCESS;
+            }
+            else if ((*policy).preempt && (*policy).preempt(sim, &cores[c].queue, active)){
+                PROFILE_COUNT(sim, preemptions, 1);
+                make_ready(sim, policy, &cores[c].queue, active);
+                cores[c].active = NO_PROCESS;
+            }
+        }
+        // Idle CPUs run their own queue first, so only what is left over gets stolen
+        for (uint32_t c = 0; c < cpu_count; c++){
+            if (cores[c].active == NO_PROCESS && cores[c].queue.length){
+                dispatch(sim, cores, c, pick_next(sim, policy, &cores[c].queue), last_core);
+            }
+        }
+        for (uint32_t c = 0; c < cpu_count; c++){
+            if (cores[c].active == NO_PROCESS){
+                uint32_t victim = longest_queue(cores, cpu_count);
+                if (!cores[victim].queue.length){
+                    break;
+                }
+                (*sim).cores[c].steals++;
+                dispatch(sim, cores, c, pick_next(sim, policy, &cores[victim].queue), last_core);
+            }
+        }
+        (*sim).currentCycle += 1;
+        (*sim).eventCount += 1;
+        skip_to_next_event_smp(sim, cores, &blocked, policy);
+    }
+    free_cores(cores, cpu_count);
+    free(last_core);
+    blocked_set_free(&blocked);
+    return 0;
+}
@@ -0,0 +1,16 @@
+#ifndef SMP_H
+#define SMP_H
+
+#include "scheduler.h"
+
+/*
+ * The multi-CPU engine, used when a run is given (*sim).cpuCount CPUs. Every CPU has its own run
+ * queue under the run's policy and runs one process at a time; the I/O device and the blocked set
+ * stay shared. A process arrives on the least loaded CPU, returns from I/O to the CPU it last ran on
+ * and is preempted back onto its own CPU's queue. An idle CPU with nothing queued steals the next
+ * process from the longest queue. With one CPU a run matches simulate exactly.
+ * Returns 0 once the run is complete, -1 if its queues can't be allocated.
+ */
+int smp_simulate(_simulation* sim, const _scheduling_policy* policy);
+
+#endif
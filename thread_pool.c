@@ -0,0 +1,241 @@
+#include "thread_pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* A queued task */
+typedef struct ThreadPoolTask {
+    _thread_pool_task task;             // The function to run
+    void* argument;                     // The argument it is run with
+    struct ThreadPoolTask* older;       // The task queued before this one on the same deque
+    struct ThreadPoolTask* newer;       // The task queued after this one on the same deque
+} _thread_pool_task_node;
+
+/* One worker and its deque. The owner takes its newest task, thieves take the oldest. */
+typedef struct ThreadPoolWorker {
+    struct ThreadPool* pool;            // The pool the worker belongs to
+    pthread_t thread;                   // The worker thread
+    pthread_mutex_t lock;               // Guards oldest and newest
+    _thread_pool_task_node* oldest;     // The end thieves steal from
+    _thread_pool_task_node* newest;     // The end the owner pushes to and pops from
+} _thread_pool_worker;
+
+struct ThreadPool {
+    pthread_mutex_t lock;               // Guards every field below except the workers' deques
+    pthread_cond_t taskQueued;          // Signalled when a task is queued or the pool is stopping
+    pthread_cond_t allDone;             // Signalled when the last outstanding task finishes
+    uint32_t queued;                    // Tasks sitting in a deque
+    uint32_t outstanding;               // Tasks queued or running
+    uint32_t nextWorker;                // The deque the next task from outside the pool goes to
+    int stopping;                       // Set once the workers should exit
+
+    _thread_pool_worker* workers;       // The workers
+    uint32_t threadCount;               // The number of workers (and deques)
+    uint32_t startedCount;              // The number of worker threads actually started
+};
+
+static __thread _thread_pool_worker* current_worker = NULL; // The worker running on this thread, if any
+
+uint32_t thread_pool_default_size(void)
+{
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return processors > 0 ? (uint32_t) processors : 1;
+}
+
+static void push_newest(_thread_pool_worker* worker, _thread_pool_task_node* node)
+{
+    pthread_mutex_lock(&(*worker).lock);
+    (*node).older = (*worker).newest;
+    (*node).newer = NULL;
+    if ((*worker).newest){
+        (*(*worker).newest).newer = node;
+    }
+    else{
+        (*worker).oldest = node;
+    }
+    (*worker).newest = node;
+    pthread_mutex_unlock(&(*worker).lock);
+}
+
+static _thread_pool_task_node* pop_newest(_thread_pool_worker* worker)
+{
+    pthread_mutex_lock(&(*worker).lock);
+    _thread_pool_task_node* node = (*worker).newest;
+    if (node){
+        (*worker).newest = (*node).older;
+        if ((*worker).newest){
+            (*(*worker).newest).newer = NULL;
+        }
+        else{
+            (*worker).oldest = NULL;
+        }
+    }
+    pthread_mutex_unlock(&(*worker).lock);
+    return node;
+}
+
+static _thread_pool_task_node* steal_oldest(_thread_pool_worker* worker)
+{
+    pthread_mutex_lock(&(*worker).lock);
+    _thread_pool_task_node* node = (*worker).oldest;
+    if (node){
+        (*worker).oldest = (*node).newer;
+        if ((*worker).oldest){
+            (*(*worker).oldest).older = NULL;
+        }
+        else{
+            (*worker).newest = NULL;
+        }
+    }
+    pthread_mutex_unlock(&(*worker).lock);
+    return node;
+}
+
+/**
+ * Takes a task from the worker's own deque, or steals one from the other workers
+ */
+static _thread_pool_task_node* find_task(_thread_pool_worker* worker)
+{
+    _thread_pool* pool = (*worker).pool;
+    _thread_pool_task_node* node = pop_newest(worker);
+    uint32_t self = (uint32_t) (worker - (*pool).workers);
+
+    for (uint32_t i = 1; !node && i < (*pool).threadCount; i++){
+        node = steal_oldest(&(*pool).workers[(self + i) % (*pool).threadCount]);
+    }
+    return node;
+}
+
+static void* worker_main(void* argument)
+{
+    _thread_pool_worker* worker = argument;
+    _thread_pool* pool = (*worker).pool;
+    current_worker = worker;
+
+    while (1){
+        _thread_pool_task_node* node = find_task(worker);
+        if (!node){
+            pthread_mutex_lock(&(*pool).lock);
+            while (!(*pool).queued && !(*pool).stopping){
+                pthread_cond_wait(&(*pool).taskQueued, &(*pool).lock);
+            }
+            int stop = !(*pool).queued && (*pool).stopping;
+            pthread_mutex_unlock(&(*pool).lock);
+            if (stop){
+                break;
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&(*pool).lock);
+        (*pool).queued--;
+        pthread_mutex_unlock(&(*pool).lock);
+
+        (*node).task((*node).argument);
+        free(node);
+
+        pthread_mutex_lock(&(*pool).lock);
+        if (--(*pool).outstanding == 0){
+            pthread_cond_broadcast(&(*pool).allDone);
+        }
+        pthread_mutex_unlock(&(*pool).lock);
+    }
+    current_worker = NULL;
+    return NULL;
+}
+
+_thread_pool* thread_pool_create(uint32_t thread_count)
+{
+    _thread_pool* pool = calloc(1, sizeof(_thread_pool));
+    if (!pool){
+        return NULL;
+    }
+    thread_count = thread_count ? thread_count : 1;
+    (*pool).workers = calloc(thread_count, sizeof(_thread_pool_worker));
+    if (!(*pool).workers){
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&(*pool).lock, NULL);
+    pthread_cond_init(&(*pool).taskQueued, NULL);
+    pthread_cond_init(&(*pool).allDone, NULL);
+    for (uint32_t i = 0; i < thread_count; i++){
+        (*pool).workers[i].pool = pool;
+        pthread_mutex_init(&(*pool).workers[i].lock, NULL);
+    }
+
+    (*pool).threadCount = thread_count;
+    for (uint32_t i = 0; i < thread_count; i++){
+        if (pthread_create(&(*pool).workers[i].thread, NULL, worker_main, &(*pool).workers[i]) != 0){
+            thread_pool_destroy(pool);
+            return NULL;
+        }
+        (*pool).startedCount++;
+    }
+    return pool;
+}
+
+int thread_pool_submit(_thread_pool* pool, _thread_pool_task task, void* argument)
+{
+    _thread_pool_task_node* node = malloc(sizeof(_thread_pool_task_node));
+    if (!node){
+        return -1;
+    }
+    (*node).task = task;
+    (*node).argument = argument;
+
+    // Counted before the push, so a worker can never finish the task before it is outstanding
+    _thread_pool_worker* worker = current_worker;
+    pthread_mutex_lock(&(*pool).lock);
+    (*pool).queued++;
+    (*pool).outstanding++;
+    if (!worker || (*worker).pool != pool){
+        worker = &(*pool).workers[(*pool).nextWorker++ % (*pool).threadCount];
+    }
+    pthread_mutex_unlock(&(*pool).lock);
+
+    // Tasks submitted by a task stay on that worker's deque until someone steals them
+    push_newest(worker, node);
+
+    pthread_mutex_lock(&(*pool).lock);
+    pthread_cond_signal(&(*pool).taskQueued);
+    pthread_mutex_unlock(&(*pool).lock);
+    return 0;
+}
+
+void thread_pool_wait(_thread_pool* pool)
+{
+    pthread_mutex_lock(&(*pool).lock);
+    while ((*pool).outstanding){
+        pthread_cond_wait(&(*pool).allDone, &(*pool).lock);
+    }
+    pthread_mutex_unlock(&(*pool).lock);
+}
+
+void thread_pool_destroy(_thread_pool* pool)
+{
+    if (!pool){
+        return;
+    }
+    if ((*pool).startedCount == (*pool).threadCount){
+        thread_pool_wait(pool);
+    }
+
+    pthread_mutex_lock(&(*pool).lock);
+    (*pool).stopping = 1;
+    pthread_cond_broadcast(&(*pool).taskQueued);
+    pthread_mutex_unlock(&(*pool).lock);
+
+    for (uint32_t i = 0; i < (*pool).startedCount; i++){
+        pthread_join((*pool).workers[i].thread, NULL);
+    }
+    for (uint32_t i = 0; i < (*pool).threadCount; i++){
+        pthread_mutex_destroy(&(*pool).workers[i].lock);
+    }
+    pthread_cond_destroy(&(*pool).allDone);
+    pthread_cond_destroy(&(*pool).taskQueued);
+    pthread_mutex_destroy(&(*pool).lock);
+    free((*pool).workers);
+    free(pool);
+}
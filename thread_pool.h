@@ -0,0 +1,36 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdint.h>
+
+typedef void (*_thread_pool_task)(void* argument);
+
+/* A fixed set of worker threads running submitted tasks */
+typedef struct ThreadPool _thread_pool;
+
+/**
+ * Returns the number of online processors (at least 1)
+ */
+uint32_t thread_pool_default_size(void);
+
+/**
+ * Starts thread_count workers. Returns NULL if the pool can't be created.
+ */
+_thread_pool* thread_pool_create(uint32_t thread_count);
+
+/**
+ * Queues task(argument) to run on a worker. Returns 0 on success, -1 if the task can't be queued.
+ */
+int thread_pool_submit(_thread_pool* pool, _thread_pool_task task, void* argument);
+
+/**
+ * Blocks until every submitted task has finished
+ */
+void thread_pool_wait(_thread_pool* pool);
+
+/**
+ * Waits for outstanding tasks, then stops and joins the workers
+ */
+void thread_pool_destroy(_thread_pool* pool);
+
+#endif
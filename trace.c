@@ -0,0 +1,127 @@
+#include "trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int trace_writer_open(_trace_writer* trace, FILE* file, uint32_t process_count, uint32_t quantum,
+                      const char* algorithm_key)
+{
+    (*trace).lastCycle = 0;
+    if (report_writer_init(&(*trace).out, file) != 0){
+        return -1;
+    }
+    report_text(&(*trace).out, TRACE_MAGIC);
+    report_char(&(*trace).out, TRACE_VERSION);
+    trace_varint(&(*trace).out, process_count);
+    trace_varint(&(*trace).out, quantum);
+    trace_varint(&(*trace).out, strlen(algorithm_key));
+    report_text(&(*trace).out, algorithm_key);
+    return 0;
+}
+
+int trace_writer_close(_trace_writer* trace, uint32_t final_cycle)
+{
+    trace_varint(&(*trace).out, final_cycle - (*trace).lastCycle);
+    trace_varint(&(*trace).out, TRACE_END);
+    return report_writer_close(&(*trace).out);
+}
+
+/**
+ * Reads a varint from in. Returns 0 on success, -1 at the end of the input or on an overlong value.
+ */
+static int read_varint(FILE* in, uint64_t* value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7){
+        int byte = getc_unlocked(in);
+        if (byte == EOF){
+            return -1;
+        }
+        *value |= (uint64_t) (byte & 0x7f) << shift;
+        if (!(byte & 0x80)){
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* A process as the decoder last saw it */
+typedef struct TraceProcess {
+    uint8_t state;                      // 0 is unstarted, 1 is ready, 2 is running, 3 is blocked, 4 is terminated
+    uint32_t burst;                     // The burst it entered the state with
+    uint32_t since;                     // The cycle it entered the state on
+} _trace_process;
+
+int trace_decode(FILE* in, FILE* out)
+{
+    static const char* names[] = { "unstarted ", "ready   ", "running ", "blocked ", "terminated " };
+    char magic[sizeof(TRACE_MAGIC) - 1];
+    uint64_t count, quantum, key_length, delta, tag, burst;
+
+    if (fread(magic, 1, sizeof(magic), in) != sizeof(magic) || memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0
+            || getc_unlocked(in) != TRACE_VERSION || read_varint(in, &count) != 0 || count > UINT32_MAX
+            || read_varint(in, &quantum) != 0 || read_varint(in, &key_length) != 0){
+        return -1;
+    }
+    for (; key_length; key_length--){
+        if (getc_unlocked(in) == EOF){
+            return -1;
+        }
+    }
+
+    _trace_process* processes = calloc(count ? count : 1, sizeof(_trace_process));
+    _report_writer text;
+    if (!processes || report_writer_init(&text, out) != 0){
+        free(processes);
+        return -2;
+    }
+
+    // Line N shows every transition made during the cycles before N, so the lines up to
+    // a record's cycle are printed before the record is applied
+    int status = 0;
+    uint32_t cycle = 0, line = 0;
+    report_text(&text, "This detailed printout gives the state and remaining burst for each process\n");
+    while (1){
+        if (read_varint(in, &delta) != 0 || read_varint(in, &tag) != 0 || cycle + delta >= UINT32_MAX){
+            status = -1;
+            break;
+        }
+        uint32_t next_cycle = cycle + (uint32_t) delta;
+        uint8_t state = tag & 7;
+        for (; line <= next_cycle; line++){
+            report_text(&text, "Before cycle\t");
+            report_uint(&text, line);
+            report_text(&text, ":\t");
+            for (uint64_t i = 0; i < count; i++){
+                const _trace_process* process = &processes[i];
+                uint32_t remaining = (*process).burst;
+                if ((*process).state == 2 || (*process).state == 3){
+                    remaining -= line - 1 - (*process).since;
+                }
+                report_text(&text, names[(*process).state]);
+                report_char(&text, '\t');
+                report_uint(&text, (*process).state == 4 ? 0 : remaining);
+                report_char(&text, '\t');
+            }
+            report_char(&text, '\n');
+        }
+        cycle = next_cycle;
+        if (state == TRACE_END){
+            break;
+        }
+        uint64_t process = tag >> 3;
+        if (state > 4 || process >= count || (state != 4 && read_varint(in, &burst) != 0)){
+            status = -1;
+            break;
+        }
+        processes[process].state = state;
+        processes[process].burst = state == 4 ? 0 : (uint32_t) burst;
+        processes[process].since = cycle;
+    }
+
+    if (report_writer_close(&text) != 0 && status == 0){
+        status = -2;
+    }
+    free(processes);
+    return status;
+}
@@ -0,0 +1,71 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "report_writer.h"
+
+#define TRACE_MAGIC "SCTR"              // The first four bytes of every trace file
+#define TRACE_VERSION 1
+#define TRACE_FILE_SUFFIX ".trace"
+#define TRACE_END 7                     // The state of the record that closes a trace (after 0-4, the process states)
+
+/*
+ * A run's state transitions as a binary log, one record per transition:
+ *   varint  cycles since the previous record
+ *   varint  process ID << 3 | new state (TRACE_END closes the log, with ID 0)
+ *   varint  the burst the process entered the state with (omitted for terminated and TRACE_END)
+ * after a header of TRACE_MAGIC, a TRACE_VERSION byte, then varints for the process count
+ * and the quantum and a length-prefixed algorithm key. Cycles in which no process changes
+ * state cost nothing, so the log grows with the number of transitions rather than processes x cycles.
+ */
+typedef struct TraceWriter {
+    _report_writer out;                 // The buffered trace file
+    uint32_t lastCycle;                 // The cycle of the previous record
+} _trace_writer;
+
+/**
+ * Starts a trace of a run of algorithm_key over process_count processes, written to file.
+ * Returns 0 on success, -1 if the buffer can't be allocated.
+ */
+int trace_writer_open(_trace_writer* trace, FILE* file, uint32_t process_count, uint32_t quantum,
+                      const char* algorithm_key);
+
+/**
+ * Closes the log with the run's final cycle and flushes it. Returns 0 if everything was written, -1 otherwise.
+ */
+int trace_writer_close(_trace_writer* trace, uint32_t final_cycle);
+
+/**
+ * Reads a trace from in and writes the "Before cycle N:" text trace to out.
+ * Returns 0 on success, -1 if in is not a well formed trace, -2 if out can't be written.
+ */
+int trace_decode(FILE* in, FILE* out);
+
+static inline void trace_varint(_report_writer* out, uint64_t value)
+{
+    char bytes[10];
+    size_t length = 0;
+    while (value >= 0x80){
+        bytes[length++] = (char) (value | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = (char) value;
+    report_bytes(out, bytes, length);
+}
+
+/**
+ * Records process entering state on cycle, with burst cycles left of its CPU or I/O burst
+ */
+static inline void trace_transition(_trace_writer* trace, uint32_t cycle, uint32_t process, uint8_t state, uint32_t burst)
+{
+    trace_varint(&(*trace).out, cycle - (*trace).lastCycle);
+    trace_varint(&(*trace).out, (uint64_t) process << 3 | state);
+    if (state != 4){
+        trace_varint(&(*trace).out, burst);
+    }
+    (*trace).lastCycle = cycle;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#include <stdio.h>
+
+#include "trace.h"
+
+/**
+ * Prints a binary trace written by scheduler --trace as the "Before cycle N:" text trace
+ */
+int main(int argc, char *argv[])
+{
+    if (argc != 2){
+        fprintf(stderr, "usage: %s trace-file|-\n", argv[0]);
+        return -1;
+    }
+    FILE* in = argv[1][0] == '-' && !argv[1][1] ? stdin : fopen(argv[1], "rb");
+    if (in == NULL){
+        printf("%s not found\n", argv[1]);
+        return -1;
+    }
+    int status = trace_decode(in, stdout);
+    if (status == -1){
+        fprintf(stderr, "%s is not a well formed trace\n", argv[1]);
+    }
+    else if (status == -2){
+        fprintf(stderr, "can't write the decoded trace\n");
+    }
+    if (in != stdin){
+        fclose(in);
+    }
+    return status;
+}
@@ -0,0 +1,202 @@
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* An inclusive range a parameter is drawn from, uniformly */
+typedef struct GenRange {
+    uint32_t low;                       // The smallest value drawn
+    uint32_t high;                      // The largest value drawn
+} _gen_range;
+
+/* The shape of a generated workload */
+typedef struct GenConfig {
+    uint32_t count;                     // The number of processes
+    uint64_t seed;                      // Seeds the generator, so a workload can be regenerated exactly
+    uint32_t arrivalSpan;               // Arrivals fall in [0, arrivalSpan]
+    int poissonArrivals;                // Exponential inter-arrival times instead of uniform arrivals
+    _gen_range B;                       // Upper bound of the CPU bursts
+    _gen_range C;                       // Total CPU time
+    _gen_range M;                       // I/O multiplier
+} _gen_config;
+
+/* A named set of B, C and M ranges */
+typedef struct GenMix {
+    const char* name;                   // The name given to --mix
+    _gen_range B;                       // Upper bound of the CPU bursts
+    _gen_range C;                       // Total CPU time
+    _gen_range M;                       // I/O multiplier
+} _gen_mix;
+
+static const _gen_mix MIXES[] = {
+    { "balanced", { 1, 10 }, { 10, 200 }, { 1, 3 } },
+    { "io", { 1, 3 }, { 10, 100 }, { 5, 20 } },       // Short bursts followed by long I/O
+    { "cpu", { 20, 100 }, { 200, 2000 }, { 1, 1 } },  // Long bursts, little I/O
+};
+
+/**
+ * xorshift64*: fast, and the same stream on every platform
+ */
+static uint64_t next_random(uint64_t* state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ull;
+}
+
+static uint32_t draw(uint64_t* state, _gen_range range)
+{
+    return range.low + (uint32_t) (next_random(state) % ((uint64_t) range.high - range.low + 1));
+}
+
+static int compare_arrivals(const void* left, const void* right)
+{
+    uint32_t a = *(const uint32_t*) left, b = *(const uint32_t*) right;
+    return a < b ? -1 : (a > b);
+}
+
+/**
+ * Parses "N" or "LOW-HIGH" into range. Returns 0 on success, -1 if it is malformed or empty.
+ */
+static int parse_range(const char* text, _gen_range* range, uint32_t minimum)
+{
+    char* end;
+    unsigned long low = strtoul(text, &end, 10), high = low;
+    if (end == text){
+        return -1;
+    }
+    if (*end == '-'){
+        const char* start = end + 1;
+        high = strtoul(start, &end, 10);
+        if (end == start){
+            return -1;
+        }
+    }
+    if (*end || low < minimum || high < low || high > UINT32_MAX / 2){
+        return -1;
+    }
+    (*range).low = (uint32_t) low;
+    (*range).high = (uint32_t) high;
+    return 0;
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr, "usage: %s [options]\n"
+                    "  -n, --count N           processes to generate (default 1000)\n"
+                    "  -s, --seed N            generator seed (default 1)\n"
+                    "  -x, --mix NAME          B/C/M preset: balanced, io or cpu (default balanced)\n"
+                    "  -a, --arrivals SPAN     arrivals fall in [0, SPAN] (default 10 per process)\n"
+                    "  -p, --poisson           exponential inter-arrival times instead of uniform arrivals\n"
+                    "  -B, --burst RANGE       B, as N or LOW-HIGH (overrides the mix)\n"
+                    "  -C, --cpu RANGE         C, as N or LOW-HIGH (overrides the mix)\n"
+                    "  -M, --io RANGE          M, as N or LOW-HIGH (overrides the mix)\n",
+            program);
+}
+
+/**
+ * Writes a random workload in the scheduler's input format to stdout
+ */
+int main(int argc, char *argv[])
+{
+    static const struct option long_options[] = {
+        { "count", required_argument, NULL, 'n' },
+        { "seed", required_argument, NULL, 's' },
+        { "mix", required_argument, NULL, 'x' },
+        { "arrivals", required_argument, NULL, 'a' },
+        { "poisson", no_argument, NULL, 'p' },
+        { "burst", required_argument, NULL, 'B' },
+        { "cpu", required_argument, NULL, 'C' },
+        { "io", required_argument, NULL, 'M' },
+        { NULL, 0, NULL, 0 }
+    };
+    _gen_config config = { 1000, 1, 0, 0, MIXES[0].B, MIXES[0].C, MIXES[0].M };
+    _gen_range B, C, M;
+    int B_given = 0, C_given = 0, M_given = 0, arrival_span_given = 0, option;
+
+    while ((option = getopt_long(argc, argv, "n:s:x:a:pB:C:M:", long_options, NULL)) != -1){
+        int valid = 1;
+        switch (option){
+            case 'n':
+                config.count = (uint32_t) strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                config.seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'x':
+                valid = 0;
+                for (size_t i = 0; i < sizeof(MIXES) / sizeof(MIXES[0]); i++){
+                    if (strcmp(optarg, MIXES[i].name) == 0){
+                        config.B = MIXES[i].B;
+                        config.C = MIXES[i].C;
+                        config.M = MIXES[i].M;
+                        valid = 1;
+                    }
+                }
+                break;
+            case 'a':
+                config.arrivalSpan = (uint32_t) strtoul(optarg, NULL, 10);
+                arrival_span_given = 1;
+                break;
+            case 'p':
+                config.poissonArrivals = 1;
+                break;
+            case 'B':
+                valid = B_given = parse_range(optarg, &B, 1) == 0;
+                break;
+            case 'C':
+                valid = C_given = parse_range(optarg, &C, 1) == 0;
+                break;
+            case 'M':
+                valid = M_given = parse_range(optarg, &M, 0) == 0;
+                break;
+            default:
+                valid = 0;
+        }
+        if (!valid){
+            usage(argv[0]);
+            return -1;
+        }
+    }
+    config.B = B_given ? B : config.B;
+    config.C = C_given ? C : config.C;
+    config.M = M_given ? M : config.M;
+    if (!arrival_span_given){
+        config.arrivalSpan = config.count > UINT32_MAX / 10 ? UINT32_MAX : config.count * 10;
+    }
+
+    uint32_t* arrivals = malloc((config.count ? config.count : 1) * sizeof(uint32_t));
+    if (!arrivals){
+        fprintf(stderr, "out of memory generating %u processes\n", config.count);
+        return -1;
+    }
+    uint64_t state = config.seed * 0x9e3779b97f4a7c15ull + 1;
+    if (config.poissonArrivals){
+        // Inter-arrival gaps with mean arrivalSpan / count, so the last arrival lands near arrivalSpan
+        double mean_gap = config.count ? (double) config.arrivalSpan / config.count : 0, clock = 0;
+        for (uint32_t i = 0; i < config.count; i++){
+            double uniform = (next_random(&state) >> 11) * (1.0 / 9007199254740992.0);
+            clock += -mean_gap * log(1.0 - uniform);
+            arrivals[i] = clock < UINT32_MAX / 2 ? (uint32_t) clock : UINT32_MAX / 2;
+        }
+    }
+    else{
+        _gen_range span = { 0, config.arrivalSpan < UINT32_MAX / 2 ? config.arrivalSpan : UINT32_MAX / 2 };
+        for (uint32_t i = 0; i < config.count; i++){
+            arrivals[i] = draw(&state, span);
+        }
+        qsort(arrivals, config.count, sizeof(uint32_t), compare_arrivals);
+    }
+
+    printf("%u", config.count);
+    for (uint32_t i = 0; i < config.count; i++){
+        uint32_t b = draw(&state, config.B), c = draw(&state, config.C), m = draw(&state, config.M);
+        printf(" (%u %u %u %u)", arrivals[i], b, c, m);
+    }
+    printf("\n");
+    free(arrivals);
+    return 0;
+}
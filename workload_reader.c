@@ -0,0 +1,170 @@
+#include "workload_reader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Refills the buffer. Returns 0 when there is nothing left to read.
+ */
+static int refill(_workload_reader* reader)
+{
+    if ((*reader).endOfInput){
+        return 0;
+    }
+    ssize_t got;
+    do {
+        got = read((*reader).fd, (*reader).buffer, WORKLOAD_READER_BUFFER_SIZE);
+    } while (got < 0 && errno == EINTR);
+    if (got <= 0){
+        (*reader).endOfInput = 1;
+        (*reader).position = (*reader).length = 0;
+        return 0;
+    }
+    (*reader).position = 0;
+    (*reader).length = (uint32_t) got;
+    return 1;
+}
+
+/**
+ * Returns the next byte without consuming it, or -1 at the end of the input
+ */
+static inline int peek(_workload_reader* reader)
+{
+    if ((*reader).position == (*reader).length && !refill(reader)){
+        return -1;
+    }
+    return (*reader).buffer[(*reader).position];
+}
+
+static inline void skip_space(_workload_reader* reader)
+{
+    int c;
+    while ((c = peek(reader)) == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'){
+        if (c == '\n'){
+            (*reader).line++;
+        }
+        (*reader).position++;
+    }
+}
+
+/**
+ * Reads an unsigned decimal number after any whitespace. Returns 0 on success, -3 otherwise.
+ */
+static int read_number(_workload_reader* reader, uint32_t* value, const char* what)
+{
+    uint64_t number = 0;
+    uint32_t digits = 0;
+    int c;
+
+    skip_space(reader);
+    while ((c = peek(reader)) >= '0' && c <= '9'){
+        number = number * 10 + (uint32_t) (c - '0');
+        if (number > UINT32_MAX){
+            (*reader).error = "number out of range";
+            return -3;
+        }
+        digits++;
+        (*reader).position++;
+    }
+    if (!digits){
+        (*reader).error = c == -1 ? "unexpected end of input" : what;
+        return -3;
+    }
+    *value = (uint32_t) number;
+    return 0;
+}
+
+static int expect(_workload_reader* reader, int expected, const char* what)
+{
+    skip_space(reader);
+    if (peek(reader) != expected){
+        (*reader).error = peek(reader) == -1 ? "unexpected end of input" : what;
+        return -3;
+    }
+    (*reader).position++;
+    return 0;
+}
+
+/**
+ * Opens the input and allocates the buffer. Returns 0 on success, -1 or -2 as workload_reader_open does.
+ */
+static int open_input(_workload_reader* reader, const char* file_name)
+{
+    memset(reader, 0, sizeof(*reader));
+    (*reader).line = 1;
+    if (strcmp(file_name, WORKLOAD_READER_STDIN) == 0){
+        (*reader).fd = STDIN_FILENO;
+    }
+    else if (((*reader).fd = open(file_name, O_RDONLY)) < 0){
+        return -1;
+    }
+    (*reader).buffer = malloc(WORKLOAD_READER_BUFFER_SIZE);
+    if (!(*reader).buffer){
+        workload_reader_close(reader);
+        return -2;
+    }
+    return 0;
+}
+
+int workload_reader_open(_workload_reader* reader, const char* file_name)
+{
+    int status = open_input(reader, file_name);
+    if (status != 0){
+        return status;
+    }
+    return read_number(reader, &(*reader).declaredCount, "expected the process count");
+}
+
+int workload_reader_open_stream(_workload_reader* reader, const char* file_name)
+{
+    int status = open_input(reader, file_name);
+    if (status != 0){
+        return status;
+    }
+    skip_space(reader);
+    if (peek(reader) >= '0' && peek(reader) <= '9'){
+        return read_number(reader, &(*reader).declaredCount, "expected the process count");
+    }
+    (*reader).declaredCount = WORKLOAD_READER_UNBOUNDED;
+    return 0;
+}
+
+int workload_reader_next(_workload_reader* reader, _process_spec* spec)
+{
+    if ((*reader).readCount == (*reader).declaredCount){
+        return 0;
+    }
+    if ((*reader).declaredCount == WORKLOAD_READER_UNBOUNDED){
+        skip_space(reader);
+        if (peek(reader) == -1){
+            return 0;
+        }
+    }
+    if (expect(reader, '(', "expected '(' to start a process") != 0
+            || read_number(reader, &(*spec).A, "expected the arrival time A") != 0
+            || read_number(reader, &(*spec).B, "expected the burst bound B") != 0
+            || read_number(reader, &(*spec).C, "expected the CPU time C") != 0
+            || read_number(reader, &(*spec).M, "expected the I/O multiplier M") != 0
+            || expect(reader, ')', "expected ')' to end a process") != 0){
+        return -3;
+    }
+    if (!(*spec).B || !(*spec).C){
+        (*reader).error = "B and C must be positive";
+        return -3;
+    }
+    (*reader).readCount++;
+    return 1;
+}
+
+void workload_reader_close(_workload_reader* reader)
+{
+    if ((*reader).fd > STDIN_FILENO){
+        close((*reader).fd);
+    }
+    (*reader).fd = -1;
+    free((*reader).buffer);
+    (*reader).buffer = NULL;
+}
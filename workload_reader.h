@@ -0,0 +1,55 @@
+#ifndef WORKLOAD_READER_H
+#define WORKLOAD_READER_H
+
+#include <stdint.h>
+
+#include "scheduler.h"
+
+#define WORKLOAD_READER_BUFFER_SIZE (1 << 16)  // Bytes read from the input at a time
+#define WORKLOAD_READER_STDIN "-"              // The file name that reads the workload from standard input
+#define WORKLOAD_READER_UNBOUNDED UINT32_MAX   // The declared count of a stream that ends where its input does
+
+/*
+ * Streams a workload ("count (A B C M) (A B C M) ...") one process at a time through a fixed buffer,
+ * so the input never has to be held in memory. Anything after the last declared process is a comment.
+ */
+typedef struct WorkloadReader {
+    int fd;                             // The input (-1 once closed)
+    unsigned char* buffer;              // The bytes read but not yet parsed start at position
+    uint32_t position;                  // The next byte to parse
+    uint32_t length;                    // The number of bytes in the buffer
+    int endOfInput;                     // Set once read has returned 0 or failed
+
+    uint32_t declaredCount;             // The process count at the start of the input
+    uint32_t readCount;                 // The number of processes read so far
+    uint32_t line;                      // The line being parsed, for error messages
+    const char* error;                  // What was wrong with the input (NULL until something is)
+} _workload_reader;
+
+/**
+ * Opens file_name (or standard input for WORKLOAD_READER_STDIN) and reads its process count.
+ * Returns 0 on success, -1 if the file can't be opened, -2 if the buffer can't be allocated,
+ * -3 if the count is malformed (see (*reader).error). The reader must be closed whatever this returns.
+ */
+int workload_reader_open(_workload_reader* reader, const char* file_name);
+
+/**
+ * Opens file_name (or standard input for WORKLOAD_READER_STDIN) as an arrival stream: a workload whose process
+ * count may be left out, in which case (*reader).declaredCount is WORKLOAD_READER_UNBOUNDED and processes are
+ * read until the input ends. Returns as workload_reader_open does.
+ */
+int workload_reader_open_stream(_workload_reader* reader, const char* file_name);
+
+/**
+ * Reads the next process into spec. Returns 1 when a process was read, 0 once all declared
+ * processes have been read (or an unbounded stream has ended), -3 if the input is malformed or ends early
+ * (see (*reader).error).
+ */
+int workload_reader_next(_workload_reader* reader, _process_spec* spec);
+
+/**
+ * Closes the input and releases the buffer
+ */
+void workload_reader_close(_workload_reader* reader);
+
+#endif